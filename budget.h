@@ -0,0 +1,88 @@
+/**
+ * @file budget.h
+ * @brief This Header implements the time and work budget that bounds a decomposition
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#pragma once
+#include <bits/stdc++.h>
+
+using namespace std;
+
+/**
+ * @brief The way a decomposition was finished
+*/
+enum DecompositionPath
+{
+    PATH_FULL,/**< split() and DCEL::merge() ran to completion */
+    PATH_SPLIT_ONLY,/**< DCEL::merge() stopped early, the remaining diagonals of split() are kept */
+    PATH_TRIANGULATED/**< split() stopped early and the rest of the polygon was triangulated */
+};
+
+/**
+ * @brief A struct representing a deadline and a no of work units a decomposition may use
+ *
+ * split() and DCEL::merge() call spend() at the start of every step and give up once it returns false.
+ * A unit is roughly one vertex visited, a step of split() costs the size of the polygon left and a step of merge() costs one.
+ * The result stays a valid convex decomposition, path tells which way it was finished.
+ *
+ * @see split() , DCEL::merge() , triangulate()
+*/
+struct Budget
+{
+    bool timed;/**< True if there is a deadline */
+    chrono::steady_clock::time_point deadline;/**< The time by which the decomposition must stop */
+    long long work;/**< The no of units left, negative for no limit */
+    bool exhausted;/**< True once the deadline has passed or the units have run out */
+    DecompositionPath path;/**< The way the decomposition was finished */
+
+    /**
+     * @brief Starts a budget that runs from now
+     *
+     * @param ms The time allowed in milliseconds, negative for no deadline
+     * @param units The no of work units allowed, negative for no limit
+    */
+    Budget(double ms = -1,long long units = -1)
+    {
+        timed = ms >= 0;
+        if(timed) deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double,milli>(ms));
+        work = units;
+        exhausted = false;
+        path = PATH_FULL;
+    }
+
+    /**
+     * @brief Uses up work units and checks the deadline
+     *
+     * @param units The no of units used by the next step
+     * @return false if the budget has run out and the step must not be taken
+    */
+    bool spend(long long units = 1)
+    {
+        if(exhausted) return false;
+        if(work >= 0)
+        {
+            work -= units;
+            if(work < 0) exhausted = true;
+        }
+        if(timed && chrono::steady_clock::now() >= deadline) exhausted = true;
+        return !exhausted;
+    }
+};
+
+/**
+ * @brief Returns the name of a decomposition path
+ *
+ * @param path The path
+ * @return FULL , SPLIT_ONLY or TRIANGULATED
+*/
+const char* path_name(DecompositionPath path)
+{
+    if(path == PATH_SPLIT_ONLY) return "SPLIT_ONLY";
+    if(path == PATH_TRIANGULATED) return "TRIANGULATED";
+    return "FULL";
+}
@@ -0,0 +1,200 @@
+/**
+ * @file client.cpp
+ * @brief This cpp implements a local client used to test the decomposition server
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#include <bits/stdc++.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "protocol.h"
+using namespace std;
+
+/**
+ * @brief Reads a polygon in the same format as the input file of the main program
+ *
+ * @param file_name The name of the file
+ * @param polygon The vector into which the coordinates are read
+ * @return false if the file could not be read
+*/
+bool read_polygon(string file_name,vector<pair<double,double>>& polygon)
+{
+    ifstream fin(file_name);
+    int n;
+    if(!(fin>>n)) return false;
+    polygon.clear();
+    for(int i=0;i<n;i++)
+    {
+        double x;
+        double y;
+        if(!(fin>>x>>y)) return false;
+        polygon.push_back({x,y});
+    }
+    return true;
+}
+
+/**
+ * @brief Connects to a server listening on a Unix domain socket
+ *
+ * @param path The path of the socket
+ * @return The file descriptor of the connection, -1 on failure
+*/
+int connect_socket(string path)
+{
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd == -1) return -1;
+    sockaddr_un addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path,path.c_str(),sizeof(addr.sun_path)-1);
+    if(connect(fd,(sockaddr*)&addr,sizeof(addr)) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Starts the server as a child process talking over pipes
+ *
+ * @param program The path of the server program, run with --serve
+ * @param in The file descriptor replies are read from
+ * @param out The file descriptor requests are written to
+ * @return The process id of the server, -1 on failure
+*/
+pid_t spawn_server(string program,int& in,int& out)
+{
+    int to_server[2];
+    int from_server[2];
+    if(pipe(to_server) == -1 || pipe(from_server) == -1) return -1;
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        dup2(to_server[0],0);
+        dup2(from_server[1],1);
+        close(to_server[1]);
+        close(from_server[0]);
+        execl(program.c_str(),program.c_str(),"--serve",(char*)NULL);
+        _exit(127);
+    }
+    close(to_server[0]);
+    close(from_server[1]);
+    out = to_server[1];
+    in = from_server[0];
+    return pid;
+}
+
+/**
+ * @brief The Main Function of the client
+ *
+ * @param argc The no of command line arguments
+ * @param argv The command line arguments
+ *
+ * Sends every polygon file given on the command line to the server and prints the no of pieces and the round trip time.
+ * Replies that ran out of the budget of the server are counted but not treated as failures.
+ * The following options are accepted
+ * - -u path : connect to a server listening on the given Unix domain socket
+ * - -e program : start the given server program with --serve and talk to it over pipes, the default is ./a.out
+ * - -r count : send every file the given no of times
+ * - --stop : ask the server to stop once all files are sent
+ *
+ * @see protocol.h
+ * @return 0 if every request succeeded
+*/
+int main(int argc,char* argv[])
+{
+    string socket_path = "";
+    string program = "./a.out";
+    int repeat = 1;
+    bool stop = false;
+    vector<string> files;
+    for(int i=1;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg == "-u" && i+1 < argc) socket_path = argv[++i];
+        else if(arg == "-e" && i+1 < argc) program = argv[++i];
+        else if(arg == "-r" && i+1 < argc) repeat = atoi(argv[++i]);
+        else if(arg == "--stop") stop = true;
+        else files.push_back(arg);
+    }
+
+    int in;
+    int out;
+    pid_t pid = -1;
+    if(socket_path != "")
+    {
+        in = out = connect_socket(socket_path);
+        if(in == -1)
+        {
+            cerr<<"Could not connect to "<<socket_path<<endl;
+            return 1;
+        }
+    }
+    else
+    {
+        pid = spawn_server(program,in,out);
+        if(pid == -1)
+        {
+            cerr<<"Could not start "<<program<<endl;
+            return 1;
+        }
+    }
+
+    LatencyTracker latency;
+    vector<pair<double,double>> polygon;
+    vector<char> request;
+    vector<char> reply;
+    vector<vector<int>> pieces;
+    int failed = 0;
+    int degraded = 0;
+    for(string& file : files)
+    {
+        if(!read_polygon(file,polygon))
+        {
+            cerr<<"Could not read "<<file<<endl;
+            failed++;
+            continue;
+        }
+        encode_polygon(polygon,request);
+        for(int r=0;r<repeat;r++)
+        {
+            auto start = chrono::steady_clock::now();
+            uint32_t status;
+            if(!write_frame(out,request) || !read_frame(in,reply) || !decode_pieces(reply,status,pieces))
+            {
+                cerr<<"Lost the connection to the server"<<endl;
+                return 1;
+            }
+            double ms = chrono::duration<double,milli>(chrono::steady_clock::now() - start).count();
+            latency.add(ms);
+            if(status == STATUS_INVALID) failed++;
+            if(status == STATUS_SPLIT_ONLY || status == STATUS_TRIANGULATED) degraded++;
+            if(r == 0) cout<<file<<" "<<polygon.size()<<" vertices "<<pieces.size()<<" pieces "<<ms<<" ms"<<endl;
+        }
+    }
+    latency.report(cout,"client");
+    if(degraded > 0) cout<<degraded<<" replies ran out of budget"<<endl;
+
+    if(stop)
+    {
+        vector<char> empty;
+        write_frame(out,empty);
+    }
+    if(pid != -1)
+    {
+        close(out);
+        close(in);
+        waitpid(pid,NULL,0);
+    }
+    else
+    {
+        close(in);
+    }
+    return failed == 0 ? 0 : 1;
+}
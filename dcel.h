@@ -8,8 +8,16 @@
  * 
  * @date 24-03-23
 */
+#pragma once
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "helper_functions.h"
+#include "budget.h"
+
+#define SNAPSHOT_VERSION 3/**< The version of the binary snapshot format written by DCEL::save_snapshot() */
 
 using namespace std;
 
@@ -22,13 +30,77 @@ class DCEL
     set<Face*> faces;/** A Set of Face Pointers to the Faces of the DCEL */
     vector<Edge*> edges;/**< A Vector of Edge Pointers to the Edges of the DCEL*/
     unordered_map<Vertex*,bool> notches;/** A Unordered Map to determine if a Vertex is a Notch or not*/
+    int notch_count;/**< The no of vertices that are notches */
     vector<Edge *> diagonal_list;/**< A Vector of Edge Pointers to the Diagonals Edges of the DCEL*/
     map<Vertex*,set<Vertex*>> LP; ;/**< A Map from Vertices to a Set of Vertices which represents the left chain for the given vertex*/
     vector<bool> LDP;/**A Vector of Boolena Values to check if an Edge is Delaunay or not*/
+    void* snapshot;/**< The mapping of the snapshot the DCEL was loaded from, NULL if it was built */
+    size_t snapshot_size;/**< The size of the mapping in bytes */
+    Edge* edge_arena;/**< The half edges of the snapshot the DCEL was loaded from, NULL if it was built */
+    size_t edge_arena_size;/**< The no of half edges in the arena */
     public:
     vector<Vertex*> vertices;/**< A Vector of Vertex Pointers to the Vertices of the DCEL*/
+    vector<int> input_index;/**< A Vector with the index in the input file of every vertex, filled by input_file() */
     
     public:
+    DCEL()
+    {
+        snapshot = NULL;
+        snapshot_size = 0;
+        edge_arena = NULL;
+        edge_arena_size = 0;
+        notch_count = 0;
+    }
+
+    ~DCEL()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Removes everything from the DCEL so it can be used for another polygon
+     * 
+     * All the vertices, half edges and faces are freed, the vectors keep their capacity
+     * If the DCEL was loaded from a snapshot the mapping and the arena are released
+     * 
+     * @see deleteEdge() , load_snapshot()
+     * @return void
+    */
+    void clear()
+    {
+        for(Face* f : faces) delete f;
+        faces.clear();
+        for(Edge* e : edges)
+        {
+            deleteEdge(e->twinEdge);
+            deleteEdge(e);
+        }
+        for(Edge* e : diagonal_list)
+        {
+            deleteEdge(e->twinEdge);
+            deleteEdge(e);
+        }
+        edges.clear();
+        diagonal_list.clear();
+        char* start = (char*)snapshot;
+        for(Vertex* v : vertices)
+        {
+            if(snapshot == NULL || (char*)v < start || (char*)v >= start + snapshot_size) delete v;
+        }
+        vertices.clear();
+        input_index.clear();
+        notches.clear();
+        notch_count = 0;
+        LP.clear();
+        LDP.clear();
+        if(edge_arena != NULL) delete[] edge_arena;
+        edge_arena = NULL;
+        edge_arena_size = 0;
+        if(snapshot != NULL) munmap(snapshot,snapshot_size);
+        snapshot = NULL;
+        snapshot_size = 0;
+    }
+
     /**
      * @brief Add the specified vertex to the DCEL and Add an Edge if required
      * 
@@ -154,8 +226,118 @@ class DCEL
         addFace(edges[0]);
         return;
     }
- 
+
+    /**
+     * @brief Builds a map layer, a set of faces sharing their vertices and edges, into the DCEL
+     *
+     * @param points The X and Y coordinates of the shared vertices
+     * @param rings The indices in points of the vertices of every face, turned clockwise in place
+     *
+     * Every vertex is created once and every ring edge gets a half edge in the face of the ring.
+     * An edge of two faces runs in opposite directions in their clockwise rings, so the two half edges are made twins.
+     * An edge of one face is on the outer boundary and gets a new twin, every such twin is linked to the one leaving the vertex it ends at.
+     * A vertex is a notch if it is a notch in any of its faces, which only makes merge_checker() stricter.
+     *
+     * @note This function assumes that the DCEL is empty, the rings are simple and do not overlap and the outer boundary does not touch itself
+     *
+     * @see addFace() , notches , addDiagonal()
+     * @return The face of every ring
+    */
+    vector<Face*> build_layer(vector<pair<double,double>>& points,vector<vector<int>>& rings)
+    {
+        long long n = points.size();
+        for(int i=0;i<n;i++)
+        {
+            Vertex* v = new Vertex();
+            v->x = points[i].first;
+            v->y = points[i].second;
+            vertices.push_back(v);
+            input_index.push_back(i);
+            notches[v] = false;
+        }
+        //Every ring edge as (u*n + v, half edge from u to v)
+        vector<pair<long long,Edge*>> ring_edges;
+        unordered_map<long long,Edge*> half;
+        vector<Face*> ring_faces;
+        for(auto& ring : rings)
+        {
+            vector<pair<double,double>> coordinates;
+            for(int k : ring) coordinates.push_back(points[k]);
+            if(!IsClockwise(coordinates)) reverse(ring.begin(),ring.end());
+            int m = ring.size();
+            int first = ring_edges.size();
+            for(int i=0;i<m;i++)
+            {
+                Edge* e = new Edge();
+                e->org = vertices[ring[i]];
+                long long key = ring[i]*n + ring[(i+1)%m];
+                ring_edges.push_back({key,e});
+                half[key] = e;
+                if(ang(vertices[ring[(i+m-1)%m]],vertices[ring[i]],vertices[ring[(i+1)%m]]) < 0) notches[e->org] = true;
+            }
+            for(int i=0;i<m;i++)
+            {
+                ring_edges[first+i].second->next = ring_edges[first+(i+1)%m].second;
+                ring_edges[first+i].second->prev = ring_edges[first+(i+m-1)%m].second;
+            }
+            ring_faces.push_back(addFace(ring_edges[first].second));
+        }
+
+        //Pair the half edges of shared edges and give the boundary edges an outer twin
+        unordered_map<Vertex*,Edge*> leaving;
+        vector<Edge*> outer;
+        for(auto& it : ring_edges)
+        {
+            Edge* e = it.second;
+            if(e->twinEdge != NULL) continue;
+            long long u = it.first/n;
+            long long v = it.first%n;
+            auto twin = half.find(v*n + u);
+            if(twin != half.end())
+            {
+                e->twinEdge = twin->second;
+                twin->second->twinEdge = e;
+            }
+            else
+            {
+                Edge* t = new Edge();
+                t->org = vertices[v];
+                t->twinEdge = e;
+                e->twinEdge = t;
+                leaving[t->org] = t;
+                outer.push_back(t);
+            }
+            edges.push_back(e);
+        }
+        for(Edge* t : outer)
+        {
+            auto it = leaving.find(t->twinEdge->org);
+            if(it == leaving.end()) continue;
+            t->next = it->second;
+            it->second->prev = t;
+        }
+        for(Vertex* v : vertices)
+        {
+            if(notches[v]) notch_count++;
+        }
+        return ring_faces;
+    }
+
     private:
+    /**
+     * @brief Frees a half edge unless it belongs to the arena of a loaded snapshot
+     * 
+     * @param e The half edge to free
+     * 
+     * @see edge_arena
+     * @return void
+    */
+    void deleteEdge(Edge* e)
+    {
+        if(edge_arena != NULL && e >= edge_arena && e < edge_arena + edge_arena_size) return;
+        delete e;
+    }
+
     /**
      * @brief Adding a Face to the DCEL 
      * 
@@ -164,10 +346,10 @@ class DCEL
      * Function adds a face to the DCEL given the incident edge
      * 
      * @see Face , faces
-     * @return void 
+     * @return The new Face
      * 
     */
-    void addFace(Edge* incident)
+    Face* addFace(Edge* incident)
     {
         //Create a new Face
         Face * f = new Face();
@@ -175,6 +357,7 @@ class DCEL
         f->incidentEdge=incident;
         //Insert into the Faces Vector 
         faces.insert(f);
+        return f;
     }
     
     /**
@@ -182,9 +365,9 @@ class DCEL
      * 
      * This function calculates the angles between every three consecutive vertices and checks if middle vertex has a notch or not
      * If the Angle is greater than 180 its a notch at the vertex otherwise no
-     * This function adds all such vertices.
+     * This function adds all such vertices and counts them.
      * 
-     * @see vertices , notches , ang
+     * @see vertices , notches , notch_count , ang
      * @return void
     */
     void add_notches()
@@ -199,6 +382,7 @@ class DCEL
             if(ans<0)
             {
                 notches[vertices[(i+1)%n]]=true;
+                notch_count++;
             }
             else
             {
@@ -223,6 +407,22 @@ class DCEL
      * @return void
     */
     void addDiagonal(vector<Vertex*>& polygon)
+    {
+        addDiagonal(polygon,faces);
+    }
+
+    /**
+     * @brief Same as addDiagonal() but only the given faces are searched
+     * 
+     * @param polygon The Vector of Vertices of the Polygon
+     * @param scope The faces to search, the face that is split is replaced in it by the two new faces
+     * 
+     * A vertex shared by the faces of a map layer is found in more than one face, the scope picks the face being split.
+     * 
+     * @see addDiagonal() , build_layer()
+     * @return void
+    */
+    void addDiagonal(vector<Vertex*>& polygon,set<Face*>& scope)
     {
         Vertex* v1 = polygon[0];
         Vertex* v2 = polygon[polygon.size()-1];
@@ -230,7 +430,7 @@ class DCEL
         Edge* v1Start = NULL;
         Face* req_face = NULL;
         Edge* v2Start = NULL;
-        for(auto face : faces){
+        for(auto face : scope){
             int cnt = 0;
             Edge* start = face->incidentEdge;
             Edge* curr = start->next;
@@ -288,11 +488,203 @@ class DCEL
             LP[new_edge->twinEdge->org].insert(new_edge->org);
  
             faces.erase(req_face);
-            addFace(new_edge);
-            addFace(new_edge_twin);
+            scope.erase(req_face);
+            delete req_face;
+            scope.insert(addFace(new_edge));
+            scope.insert(addFace(new_edge_twin));
         }
     }
  
+    /**
+     * @brief The Function adds all the diagonals of a polygon at once
+     * 
+     * @param diagonals The diagonals as pairs of indices into vertices, in the order they are added to the diagonal list
+     * 
+     * Pairs that are edges of the polygon or repeat an earlier diagonal are skipped.
+     * The diagonals at every vertex are sorted by how far their other end is along the polygon using two counting sorts,
+     * which for non crossing diagonals is also their order around the vertex.
+     * A half edge arriving at a vertex is then followed by the half edge leaving just before it in that order,
+     * and the faces are found by walking these links once, all in O(n + d).
+     * The LP Map is updated the same way as addDiagonal().
+     * 
+     * @note This function assumes that the DCEL holds a joined polygon without diagonals, otherwise it calls addDiagonal() for every pair
+     * 
+     * @see addDiagonal() , LP , faces , diagonal_list
+     * @return void
+    */
+    void addDiagonals(vector<pair<int,int>>& diagonals)
+    {
+        int n = vertices.size();
+        if(edges.size() != n || faces.size() != 1 || !diagonal_list.empty())
+        {
+            for(auto& d : diagonals)
+            {
+                vector<Vertex*> polygon = {vertices[d.first],vertices[d.second]};
+                addDiagonal(polygon);
+            }
+            return;
+        }
+        //Every diagonal seen from both of its ends as (origin, offset of the other end, diagonal)
+        vector<array<int,3>> ends;
+        for(int k=0;k<diagonals.size();k++)
+        {
+            int a = diagonals[k].first;
+            int b = diagonals[k].second;
+            int offset = (b-a+n)%n;
+            if(offset <= 1 || offset == n-1) continue;
+            ends.push_back({a,offset,k});
+            ends.push_back({b,n-offset,k});
+        }
+        auto counting_sort = [&](int key,int range)
+        {
+            vector<int> start(range+1,0);
+            for(auto& e : ends) start[e[key]+1]++;
+            for(int i=0;i<range;i++) start[i+1] += start[i];
+            vector<array<int,3>> sorted(ends.size());
+            for(auto& e : ends) sorted[start[e[key]]++] = e;
+            ends.swap(sorted);
+        };
+        counting_sort(1,n);
+        counting_sort(0,n);
+
+        //Drop repeated diagonals, they are next to each other at both ends
+        vector<bool> repeated(diagonals.size(),false);
+        for(int i=1;i<ends.size();i++)
+        {
+            if(ends[i][0] == ends[i-1][0] && ends[i][1] == ends[i-1][1]) repeated[ends[i][2]] = true;
+        }
+        //Half edge n+2k goes from the second vertex of diagonal k to the first and n+2k+1 is its twin
+        vector<Edge*> half(n + 2*diagonals.size(),NULL);
+        for(int i=0;i<n;i++) half[i] = edges[i];
+        for(int k=0;k<diagonals.size();k++)
+        {
+            int offset = (diagonals[k].second-diagonals[k].first+n)%n;
+            if(repeated[k] || offset <= 1 || offset == n-1) continue;
+            Edge* e = new Edge();
+            Edge* t = new Edge();
+            e->org = vertices[diagonals[k].second];
+            t->org = vertices[diagonals[k].first];
+            e->twinEdge = t;
+            t->twinEdge = e;
+            half[n+2*k] = e;
+            half[n+2*k+1] = t;
+            diagonal_list.push_back(e);
+            LP[e->org].insert(t->org);
+            LP[t->org].insert(e->org);
+        }
+
+        //Link the half edges around every vertex
+        vector<int> next_id(half.size(),-1);
+        int i = 0;
+        for(int v=0;v<n;v++)
+        {
+            int out = v;
+            for(; i<ends.size() && ends[i][0] == v; i++)
+            {
+                int k = ends[i][2];
+                if(repeated[k]) continue;
+                bool second = diagonals[k].second == v;
+                int leaving = second ? n+2*k : n+2*k+1;
+                int arriving = second ? n+2*k+1 : n+2*k;
+                next_id[arriving] = out;
+                out = leaving;
+            }
+            next_id[(v-1+n)%n] = out;
+        }
+        for(int id=0;id<half.size();id++)
+        {
+            if(half[id] == NULL) continue;
+            half[id]->next = half[next_id[id]];
+            half[next_id[id]]->prev = half[id];
+        }
+
+        //Walk the faces
+        for(Face* f : faces) delete f;
+        faces.clear();
+        vector<bool> visited(half.size(),false);
+        for(int id=0;id<half.size();id++)
+        {
+            if(half[id] == NULL || visited[id]) continue;
+            int curr = id;
+            do {
+                visited[curr] = true;
+                curr = next_id[curr];
+            }while(curr != id);
+            addFace(half[id]);
+        }
+    }
+
+    /**
+     * @brief Checks if the polygon is convex
+     * 
+     * @see notch_count , add_notches()
+     * @return true if the polygon has no notches
+    */
+    bool isConvex()
+    {
+        return notch_count == 0;
+    }
+
+    /**
+     * @brief Returns the faces of the DCEL
+     * 
+     * @see faces
+     * @return A vector of pointers to the faces
+    */
+    vector<Face*> getFaces()
+    {
+        return vector<Face*>(faces.begin(),faces.end());
+    }
+
+    /**
+     * @brief Returns the diagonals of the DCEL
+     * 
+     * @see diagonal_list
+     * @return A vector of half edges, one for every diagonal
+    */
+    vector<Edge*> getDiagonals()
+    {
+        return diagonal_list;
+    }
+
+    /**
+     * @brief Returns the edges of the polygon
+     * 
+     * @see edges
+     * @return A vector of half edges, one for every edge
+    */
+    vector<Edge*> getEdges()
+    {
+        return edges;
+    }
+
+    /**
+     * @brief Estimates the no of bytes used by every part of the DCEL
+     *
+     * The nodes of a set or map are counted with a header of 4 pointers and the nodes of an unordered map with 1 pointer,
+     * as in the GNU standard library. The padding added by malloc is not counted.
+     * Objects in a loaded snapshot are counted even though they live in the mapping or the edge arena.
+     *
+     * @see vertices , edges , faces , LP , notches , diagonal_list , MemoryReport
+     * @return The name and size in bytes of every part
+    */
+    vector<pair<string,size_t>> memory_usage()
+    {
+        const size_t tree_node = 4*sizeof(void*);
+        const size_t hash_node = sizeof(void*);
+        size_t half_edges = 2*(edges.size() + diagonal_list.size());
+        size_t lp = LP.size()*(tree_node + sizeof(pair<Vertex* const,set<Vertex*>>));
+        for(auto& it : LP) lp += it.second.size()*(tree_node + sizeof(Vertex*));
+        vector<pair<string,size_t>> parts;
+        parts.push_back({"vertices",vertices.size()*sizeof(Vertex) + vertices.capacity()*sizeof(Vertex*) + input_index.capacity()*sizeof(int)});
+        parts.push_back({"edges",half_edges*sizeof(Edge) + edges.capacity()*sizeof(Edge*)});
+        parts.push_back({"faces",faces.size()*(sizeof(Face) + tree_node + sizeof(Face*))});
+        parts.push_back({"LP",lp});
+        parts.push_back({"notches",notches.size()*(hash_node + sizeof(pair<Vertex* const,bool>)) + notches.bucket_count()*sizeof(void*)});
+        parts.push_back({"diagonal_list",diagonal_list.capacity()*sizeof(Edge*) + LDP.capacity()/8});
+        return parts;
+    }
+
     /**
      * @brief The Function checks if two vertices are adjacent
      * 
@@ -377,6 +769,8 @@ class DCEL
         diagonal->twinEdge->prev->next = diagonal->next;
         faces.erase(adj_faces[0]);
         faces.erase(adj_faces[1]);
+        delete adj_faces[0];
+        delete adj_faces[1];
         addFace(diagonal->next);
     }
  
@@ -384,16 +778,25 @@ class DCEL
      * @brief Merges the vertices of a polygon by removing some of the diagonal edges whose removing will not affect the convexity of ploygon. 
      * If merge_checker function is satisfied goes onto check other conditons.
      * 
-     * This function checks all diagonals of the polygon and see if they can be removed or not
+     * @param from The index in the diagonal list of the first diagonal that may be removed
+     * @param budget The budget that bounds the merge, NULL for no limit
+     * 
+     * This function checks all diagonals of the polygon from the given index and see if they can be removed or not
      * The diagonal edges not removed are stored as essential diagonals in a vector
+     * If the budget runs out the diagonals not checked yet are kept and the path of the budget is set to PATH_SPLIT_ONLY
      * 
-     * @see Vertex , LDP , ang() , Edge , diagonal , merge_checker() , LP , removeDiagonal()
+     * @see Vertex , LDP , ang() , Edge , diagonal , merge_checker() , LP , removeDiagonal() , Budget
     */
-    void merge()
+    void merge(int from = 0,Budget* budget = NULL)
     {
-        LDP.resize(diagonal_list.size(),true);
-        for(int i=0;i<diagonal_list.size();i++)
+        LDP.assign(diagonal_list.size(),true);
+        for(int i=from;i<diagonal_list.size();i++)
         {
+            if(budget != NULL && !budget->spend())
+            {
+                if(budget->path == PATH_FULL) budget->path = PATH_SPLIT_ONLY;
+                break;
+            }
             Vertex *vs = diagonal_list[i]->org;
             Vertex *vt =diagonal_list[i]->twinEdge->org;
             if(merge_checker(vs,vt))
@@ -419,6 +822,11 @@ class DCEL
         for(int i=0;i<diagonal_list.size();i++)
         {
             if(LDP[i]) essen_diagonals.push_back(diagonal_list[i]);
+            else
+            {
+                deleteEdge(diagonal_list[i]->twinEdge);
+                deleteEdge(diagonal_list[i]);
+            }
         }
         diagonal_list = essen_diagonals;
     }
@@ -448,4 +856,263 @@ class DCEL
             fout<<diagonal_list[i]->org->x<<" "<<diagonal_list[i]->org->y<<" "<<diagonal_list[i]->twinEdge->org->x<<" "<<diagonal_list[i]->twinEdge->org->y<<endl;
         }
 }
+
+    /**
+     * @brief This function packs the complete DCEL into arrays of indices
+     * 
+     * Every vertex and reachable half edge is given an index and all the pointers are stored as indices.
+     * The arrays follow the layout of the snapshot described in SnapshotHeader.
+     * 
+     * @see PackedDCEL , SnapshotHeader , save_snapshot() , FrozenDCEL
+     * @return The packed DCEL
+    */
+    PackedDCEL pack()
+    {
+        PackedDCEL packed;
+        unordered_map<Vertex*,int32_t> vertex_index;
+        for(int i=0;i<vertices.size();i++) vertex_index[vertices[i]] = i;
+        vector<Edge*> half;
+        unordered_map<Edge*,int32_t> half_index;
+        auto add = [&](Edge* e)
+        {
+            if(e != NULL && half_index.find(e) == half_index.end())
+            {
+                half_index[e] = half.size();
+                half.push_back(e);
+            }
+        };
+        for(Edge* e : edges)
+        {
+            add(e);
+            add(e->twinEdge);
+        }
+        for(Edge* e : diagonal_list)
+        {
+            add(e);
+            add(e->twinEdge);
+        }
+        auto edge_id = [&](Edge* e) { return e == NULL ? -1 : half_index[e]; };
+
+        for(Vertex* v : vertices) packed.coordinates.push_back(*v);
+        for(Edge* e : half)
+        {
+            packed.links.push_back(vertex_index[e->org]);
+            packed.links.push_back(edge_id(e->twinEdge));
+            packed.links.push_back(edge_id(e->prev));
+            packed.links.push_back(edge_id(e->next));
+        }
+        for(Edge* e : edges) packed.edges.push_back(edge_id(e));
+        for(Face* f : faces) packed.faces.push_back(edge_id(f->incidentEdge));
+        for(Edge* e : diagonal_list) packed.diagonals.push_back(edge_id(e));
+        for(int i=0;i<vertices.size();i++)
+        {
+            packed.lp_start.push_back(packed.lp.size());
+            auto it = LP.find(vertices[i]);
+            if(it == LP.end()) continue;
+            for(Vertex* v : it->second) packed.lp.push_back(vertex_index[v]);
+        }
+        packed.lp_start.push_back(packed.lp.size());
+        for(int k : input_index) packed.input_index.push_back(k);
+        for(Vertex* v : vertices)
+        {
+            auto it = notches.find(v);
+            packed.notches.push_back(it != notches.end() && it->second);
+        }
+        return packed;
+    }
+
+    /**
+     * @brief This function writes the complete DCEL into a binary snapshot
+     * 
+     * @param file_name The filename into which the snapshot is written
+     * @param from The index of the first diagonal still to be merged, stored so a tiled split is merged the same way after loading
+     * @param polygons The no of polygons in the DCEL, stored so the faces of a map layer can be validated after loading
+     * 
+     * The DCEL is packed by pack() and the arrays are written in the layout described in SnapshotHeader.
+     * 
+     * @see SnapshotHeader , pack() , load_snapshot() , merge()
+     * @return true if the file was written
+    */
+    bool save_snapshot(string file_name,int from = 0,int polygons = 1)
+    {
+        file_name+=".dcel";
+        PackedDCEL packed = pack();
+
+        SnapshotHeader header;
+        memcpy(header.magic,"DCEL",4);
+        header.version = SNAPSHOT_VERSION;
+        header.vertices = packed.coordinates.size();
+        header.half_edges = packed.links.size()/4;
+        header.edges = packed.edges.size();
+        header.faces = packed.faces.size();
+        header.diagonals = packed.diagonals.size();
+        header.lp = packed.lp.size();
+        header.input_index = packed.input_index.size();
+        header.from = from;
+        header.polygons = polygons;
+
+        ofstream fout(file_name,ios::binary);
+        auto write = [&](const void* data,size_t bytes)
+        {
+            fout.write((const char*)data,bytes);
+            static const char zero[8] = {0};
+            fout.write(zero,(8 - bytes%8)%8);
+        };
+        write(&header,sizeof(header));
+        write(packed.coordinates.data(),packed.coordinates.size()*sizeof(Vertex));
+        write(packed.links.data(),packed.links.size()*sizeof(int32_t));
+        write(packed.edges.data(),packed.edges.size()*sizeof(int32_t));
+        write(packed.faces.data(),packed.faces.size()*sizeof(int32_t));
+        write(packed.diagonals.data(),packed.diagonals.size()*sizeof(int32_t));
+        write(packed.lp_start.data(),packed.lp_start.size()*sizeof(int32_t));
+        write(packed.lp.data(),packed.lp.size()*sizeof(int32_t));
+        write(packed.input_index.data(),packed.input_index.size()*sizeof(int32_t));
+        write(packed.notches.data(),packed.notches.size());
+        return fout.good();
+    }
+
+    /**
+     * @brief This function loads a binary snapshot written by save_snapshot() into an empty DCEL
+     * 
+     * @param file_name The filename of the snapshot
+     * @param from The variable into which the index of the first diagonal still to be merged is written, can be NULL
+     * @param polygons The variable into which the no of polygons in the DCEL is written, can be NULL
+     * 
+     * The file is mapped privately and the vertices point directly into the mapping.
+     * Every count in the header and every index in the sections is checked before anything is built,
+     * a file with a negative or too large count, an index out of range or half edges whose links do not pair up is rejected.
+     * The half edges are then allocated together and their indices are turned back into pointers.
+     * 
+     * @note This function assumes that the DCEL is empty
+     * 
+     * @see SnapshotHeader , save_snapshot()
+     * @return false if the file is missing or is not a valid snapshot
+    */
+    bool load_snapshot(string file_name,int* from = NULL,int* polygons = NULL)
+    {
+        file_name+=".dcel";
+        int fd = open(file_name.c_str(),O_RDONLY);
+        if(fd == -1) return false;
+        struct stat st;
+        if(fstat(fd,&st) == -1 || st.st_size < (off_t)sizeof(SnapshotHeader))
+        {
+            close(fd);
+            return false;
+        }
+        void* data = mmap(NULL,st.st_size,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0);
+        close(fd);
+        if(data == MAP_FAILED) return false;
+        auto reject = [&]()
+        {
+            munmap(data,st.st_size);
+            return false;
+        };
+
+        //Every count is used as an int32 index so bounding them also keeps the sizes below from overflowing
+        SnapshotHeader* header = (SnapshotHeader*)data;
+        if(memcmp(header->magic,"DCEL",4) != 0 || header->version != SNAPSHOT_VERSION) return reject();
+        int64_t counts[] = {header->vertices+1,header->half_edges,header->edges,header->faces,header->diagonals,header->lp,header->input_index};
+        for(int64_t c : counts)
+        {
+            if(c < 0 || c > INT32_MAX) return reject();
+        }
+        if(header->vertices < 0 || header->from < 0 || header->from > header->diagonals) return reject();
+        if(header->polygons < 1 || header->polygons > INT32_MAX) return reject();
+        auto padded = [](size_t bytes) { return (bytes + 7)/8*8; };
+        size_t expected = padded(sizeof(SnapshotHeader)) + padded(header->vertices*sizeof(Vertex))
+            + padded(header->half_edges*4*sizeof(int32_t)) + padded(header->edges*sizeof(int32_t))
+            + padded(header->faces*sizeof(int32_t)) + padded(header->diagonals*sizeof(int32_t))
+            + padded((header->vertices+1)*sizeof(int32_t)) + padded(header->lp*sizeof(int32_t))
+            + padded(header->input_index*sizeof(int32_t)) + padded(header->vertices);
+        if(expected != (size_t)st.st_size) return reject();
+
+        char* p = (char*)data + padded(sizeof(SnapshotHeader));
+        auto section = [&](size_t bytes) { char* start = p; p += padded(bytes); return start; };
+        Vertex* coordinates = (Vertex*)section(header->vertices*sizeof(Vertex));
+        int32_t* links = (int32_t*)section(header->half_edges*4*sizeof(int32_t));
+        int32_t* edge_list = (int32_t*)section(header->edges*sizeof(int32_t));
+        int32_t* face_list = (int32_t*)section(header->faces*sizeof(int32_t));
+        int32_t* diagonals = (int32_t*)section(header->diagonals*sizeof(int32_t));
+        int32_t* lp_start = (int32_t*)section((header->vertices+1)*sizeof(int32_t));
+        int32_t* lp = (int32_t*)section(header->lp*sizeof(int32_t));
+        int32_t* index = (int32_t*)section(header->input_index*sizeof(int32_t));
+        uint8_t* notch = (uint8_t*)section(header->vertices);
+
+        //Check every index before any pointer is built from it
+        auto in_range = [](int32_t k,int64_t size) { return k >= 0 && k < size; };
+        for(int64_t i=0;i<header->half_edges;i++)
+        {
+            if(!in_range(links[4*i],header->vertices)) return reject();
+            for(int l=1;l<4;l++)
+            {
+                if(!in_range(links[4*i+l],header->half_edges)) return reject();
+            }
+        }
+        //The links must pair up so every walk along next or around a vertex comes back to where it started
+        for(int64_t i=0;i<header->half_edges;i++)
+        {
+            int32_t twin = links[4*i+1];
+            int32_t prev = links[4*i+2];
+            int32_t next = links[4*i+3];
+            if(twin == i || links[4*twin+1] != i || links[4*prev+3] != i || links[4*next+2] != i) return reject();
+            if(links[4*next] != links[4*twin]) return reject();
+        }
+        for(int64_t i=0;i<header->edges;i++)
+        {
+            if(!in_range(edge_list[i],header->half_edges)) return reject();
+        }
+        for(int64_t i=0;i<header->faces;i++)
+        {
+            if(!in_range(face_list[i],header->half_edges)) return reject();
+        }
+        for(int64_t i=0;i<header->diagonals;i++)
+        {
+            if(!in_range(diagonals[i],header->half_edges)) return reject();
+        }
+        if(lp_start[0] != 0 || lp_start[header->vertices] != header->lp) return reject();
+        for(int64_t i=0;i<header->vertices;i++)
+        {
+            if(lp_start[i] > lp_start[i+1]) return reject();
+        }
+        for(int64_t i=0;i<header->lp;i++)
+        {
+            if(!in_range(lp[i],header->vertices)) return reject();
+        }
+        for(int64_t i=0;i<header->input_index;i++)
+        {
+            if(index[i] < 0) return reject();
+        }
+        snapshot = data;
+        snapshot_size = st.st_size;
+        if(from != NULL) *from = header->from;
+        if(polygons != NULL) *polygons = header->polygons;
+
+        for(int64_t i=0;i<header->vertices;i++) vertices.push_back(&coordinates[i]);
+        edge_arena = new Edge[header->half_edges];
+        edge_arena_size = header->half_edges;
+        auto edge_ptr = [&](int32_t k) { return k == -1 ? (Edge*)NULL : &edge_arena[k]; };
+        for(int64_t i=0;i<header->half_edges;i++)
+        {
+            edge_arena[i].org = vertices[links[4*i]];
+            edge_arena[i].twinEdge = edge_ptr(links[4*i+1]);
+            edge_arena[i].prev = edge_ptr(links[4*i+2]);
+            edge_arena[i].next = edge_ptr(links[4*i+3]);
+        }
+        for(int64_t i=0;i<header->edges;i++) edges.push_back(edge_ptr(edge_list[i]));
+        for(int64_t i=0;i<header->faces;i++) addFace(edge_ptr(face_list[i]));
+        for(int64_t i=0;i<header->diagonals;i++) diagonal_list.push_back(edge_ptr(diagonals[i]));
+        for(int64_t i=0;i<header->vertices;i++)
+        {
+            if(lp_start[i] == lp_start[i+1]) continue;
+            set<Vertex*>& chain = LP[vertices[i]];
+            for(int32_t k=lp_start[i];k<lp_start[i+1];k++) chain.insert(vertices[lp[k]]);
+        }
+        input_index.assign(index,index+header->input_index);
+        for(int64_t i=0;i<header->vertices;i++)
+        {
+            notches[vertices[i]] = notch[i];
+            notch_count += notch[i];
+        }
+        return true;
+    }
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
  * 
  * @date 24-03-23
 */
+#pragma once
 #include <bits/stdc++.h>
 #include <cmath>
 #include "helper_structs.h"
@@ -22,9 +23,18 @@ bool isNotch(Vertex*v1,Vertex* v2,Vertex* v3);
 void  removeFromSemiPlane(vector<Vertex*>& polygon,Vertex* inside);
 bool sameSide(Vertex *v1, Vertex*v2, Vertex*v3, Vertex*v4);
 vector<double> getRectangle(vector<Vertex*>& polygon);
-bool insideRect(vector<double> rect,Vertex* v);
+bool insideRect(const vector<double>& rect,Vertex* v);
 bool insidePolygon(vector<Vertex*>& polygon,Vertex* v);
 bool IsClockwise(vector<pair<double,double>> vertices);
+bool removable(pair<double,double>& a,pair<double,double>& b,pair<double,double>& c,double tolerance);
+vector<int> simplify(vector<pair<double,double>>& vertices,double tolerance);
+double cross(Vertex* v1,Vertex* v2,Vertex* v3);
+bool segmentsIntersect(Vertex* p1,Vertex* p2,Vertex* q1,Vertex* q2);
+bool validDiagonal(vector<Vertex*>& polygon,int i,int j);
+bool findCut(vector<Vertex*>& polygon,int& a,int& b);
+double polygonArea(vector<Vertex*>& polygon);
+double polygonArea(vector<pair<double,double>>& vertices,vector<int>* ring = NULL);
+vector<vector<Vertex*>> triangulate(vector<Vertex*>& polygon);
 
 
 /**
@@ -191,7 +201,7 @@ vector<double> getRectangle(vector<Vertex*>& polygon)
  * @see Vertex
  * @return true if point lies in the rectangle
 */
-bool insideRect(vector<double> rect,Vertex* v)
+bool insideRect(const vector<double>& rect,Vertex* v)
 {
     if((rect[0] < v->x && rect[1] > v->x) && (rect[2] < v->y && rect[3] > v->y))
     {
@@ -253,3 +263,414 @@ bool IsClockwise(vector<pair<double,double>> vertices){
     }
     return sum > 0.0;
 }
+
+/**
+ * @brief Checks if a vertex can be dropped from between two kept vertices without moving the boundary more than the tolerance
+ * 
+ * @param a The previous kept vertex
+ * @param b The vertex we check for removal
+ * @param c The next kept vertex
+ * @param tolerance The maximum allowed distance of b from the segment from a to c
+ * 
+ * The distance is measured to the segment, not the line, so a spike beyond either end is never removable
+ * 
+ * @return true if b is within the tolerance of the segment
+*/
+bool removable(pair<double,double>& a,pair<double,double>& b,pair<double,double>& c,double tolerance)
+{
+    double dx = c.first - a.first;
+    double dy = c.second - a.second;
+    double len2 = dx*dx + dy*dy;
+    double t = 0;
+    if(len2 > 0)
+    {
+        t = ((b.first - a.first)*dx + (b.second - a.second)*dy)/len2;
+        t = max(0.0,min(1.0,t));
+    }
+    return hypot(b.first - (a.first + t*dx),b.second - (a.second + t*dy)) <= tolerance;
+}
+
+/**
+ * @brief Removes duplicate, collinear and near collinear vertices from the input polygon in a single pass
+ * 
+ * @param vertices A vector of pairs having the X and Y Coordinates, modified in place
+ * @param tolerance The largest distance any removed vertex may have from the simplified boundary
+ * 
+ * This is the sleeve fitting method of Zhao and Saalfeld.
+ * From the last kept vertex, the anchor, every vertex dropped since is within the tolerance of a line whose direction lies in
+ * an interval of half width asin(tolerance / distance) around the direction of that vertex, and the cone is the intersection of these intervals.
+ * The next vertex becomes the end of the chord if its direction is in the cone and it is at least as far from the anchor as every dropped vertex,
+ * which together keep every dropped vertex within the tolerance of the chord as a segment. Otherwise the previous end is kept and becomes the anchor.
+ * Every vertex is handled once so the pass is O(n).
+ * At the end the first and last kept vertices are dropped while all the vertices across the wrap around are still within the tolerance.
+ * The result never has less than three vertices.
+ * 
+ * @see removable()
+ * @return The original index of every vertex that is kept, in order
+*/
+vector<int> simplify(vector<pair<double,double>>& vertices,double tolerance)
+{
+    int n = vertices.size();
+    vector<int> kept;
+    if(n == 0) return kept;
+    kept.push_back(0);
+    int end = -1;
+    double lo = -INFINITY;
+    double hi = INFINITY;
+    double reach = 0;
+    double base = 0;
+    bool has_base = false;
+    auto distance = [&](int i) { return hypot(vertices[i].first - vertices[kept.back()].first,vertices[i].second - vertices[kept.back()].second); };
+    //The direction of a vertex from the anchor relative to the first direction seen, in (-pi,pi]
+    auto direction = [&](int i)
+    {
+        double d = atan2(vertices[i].second - vertices[kept.back()].second,vertices[i].first - vertices[kept.back()].first) - base;
+        while(d > M_PI) d -= 2*M_PI;
+        while(d <= -M_PI) d += 2*M_PI;
+        return d;
+    };
+    for(int i = 1; i < n; i++)
+    {
+        if(end == -1)
+        {
+            end = i;
+            continue;
+        }
+        //Tentatively drop the current end
+        double r = distance(end);
+        double new_lo = lo;
+        double new_hi = hi;
+        if(r > tolerance)
+        {
+            if(!has_base)
+            {
+                base = direction(end);
+                has_base = true;
+            }
+            double d = direction(end);
+            double w = asin(tolerance/r);
+            new_lo = max(new_lo,d - w);
+            new_hi = min(new_hi,d + w);
+        }
+        double new_reach = max(reach,r);
+        double ri = distance(i);
+        bool fits = ri >= new_reach && (ri <= tolerance || (new_lo <= new_hi && (!has_base || (direction(i) >= new_lo && direction(i) <= new_hi))));
+        if(fits)
+        {
+            lo = new_lo;
+            hi = new_hi;
+            reach = new_reach;
+            end = i;
+        }
+        else
+        {
+            kept.push_back(end);
+            end = i;
+            lo = -INFINITY;
+            hi = INFINITY;
+            reach = 0;
+            has_base = false;
+        }
+    }
+    if(end != -1) kept.push_back(end);
+
+    //Handle the wrap around, the front of the stack is removed by moving the start index
+    auto covers = [&](int from,int to)
+    {
+        for(int k = (from+1)%n; k != to; k = (k+1)%n)
+        {
+            if(!removable(vertices[from],vertices[k],vertices[to],tolerance)) return false;
+        }
+        return true;
+    };
+    int start = 0;
+    bool changed = true;
+    while(changed && (int)kept.size() - start > 3)
+    {
+        changed = false;
+        if(covers(kept[kept.size()-2],kept[start]))
+        {
+            kept.pop_back();
+            changed = true;
+        }
+        else if(covers(kept.back(),kept[start+1]))
+        {
+            start++;
+            changed = true;
+        }
+    }
+    vector<int> index(kept.begin()+start,kept.end());
+    vector<pair<double,double>> result;
+    for(int i = 0; i < index.size(); i++)
+    {
+        result.push_back(vertices[index[i]]);
+    }
+    vertices = result;
+    return index;
+}
+
+/**
+ * @brief Calculates the cross product of the vectors from v1 to v2 and from v1 to v3
+ * 
+ * @param v1 The common start vertex
+ * @param v2 The end of the first vector
+ * @param v3 The end of the second vector
+ * 
+ * @return The cross product, positive if v3 is to the left of the line from v1 to v2
+*/
+double cross(Vertex* v1,Vertex* v2,Vertex* v3)
+{
+    return (v2->x - v1->x)*(v3->y - v1->y) - (v2->y - v1->y)*(v3->x - v1->x);
+}
+
+/**
+ * @brief Checks if two closed line segments have a common point
+ * 
+ * @param p1 The first end of the first segment
+ * @param p2 The second end of the first segment
+ * @param q1 The first end of the second segment
+ * @param q2 The second end of the second segment
+ * 
+ * The segments intersect if the ends of each are on different sides of the other
+ * Collinear segments intersect if their bounding boxes overlap
+ * 
+ * @see cross()
+ * @return true if the segments intersect or touch
+*/
+bool segmentsIntersect(Vertex* p1,Vertex* p2,Vertex* q1,Vertex* q2)
+{
+    double d1 = cross(q1,q2,p1);
+    double d2 = cross(q1,q2,p2);
+    double d3 = cross(p1,p2,q1);
+    double d4 = cross(p1,p2,q2);
+    if(d1 == 0 && d2 == 0)
+    {
+        return max(p1->x,p2->x) >= min(q1->x,q2->x) && max(q1->x,q2->x) >= min(p1->x,p2->x)
+            && max(p1->y,p2->y) >= min(q1->y,q2->y) && max(q1->y,q2->y) >= min(p1->y,p2->y);
+    }
+    return ((d1 <= 0 && d2 >= 0) || (d1 >= 0 && d2 <= 0)) && ((d3 <= 0 && d4 >= 0) || (d3 >= 0 && d4 <= 0));
+}
+
+/**
+ * @brief Checks if the segment between two vertices of a polygon is a diagonal
+ * 
+ * @param polygon The Vector of Vertices of the Polygon
+ * @param i The index of the first vertex
+ * @param j The index of the second vertex
+ * 
+ * The segment is a diagonal if the vertices are not adjacent, it does not touch any edge other than the ones at its ends
+ * and its midpoint lies inside the polygon
+ * 
+ * @see segmentsIntersect() , insidePolygon()
+ * @return true if the segment is a diagonal
+*/
+bool validDiagonal(vector<Vertex*>& polygon,int i,int j)
+{
+    int n = polygon.size();
+    if(i == j || (i+1)%n == j || (j+1)%n == i)
+    {
+        return false;
+    }
+    for(int k = 0; k < n; k++)
+    {
+        int l = (k+1)%n;
+        if(k == i || k == j || l == i || l == j) continue;
+        if(segmentsIntersect(polygon[i],polygon[j],polygon[k],polygon[l])) return false;
+    }
+    Vertex mid;
+    mid.x = (polygon[i]->x + polygon[j]->x)/2;
+    mid.y = (polygon[i]->y + polygon[j]->y)/2;
+    return insidePolygon(polygon,&mid);
+}
+
+/**
+ * @brief Finds a diagonal that cuts the polygon into two parts of similar size
+ * 
+ * @param polygon The Vector of Vertices of the Polygon
+ * @param a The index of the first vertex of the diagonal, set if one is found
+ * @param b The index of the second vertex of the diagonal, set if one is found
+ * 
+ * The polygon is cut across the median of its longer side
+ * The vertices closest to the median are tried in pairs and the first diagonal leaving atleast a quarter of the vertices on each side is taken
+ * 
+ * @see getRectangle() , validDiagonal()
+ * @return true if a diagonal is found
+*/
+bool findCut(vector<Vertex*>& polygon,int& a,int& b)
+{
+    int n = polygon.size();
+    if(n < 8)
+    {
+        return false;
+    }
+    vector<double> rect = getRectangle(polygon);
+    bool along_x = rect[1] - rect[0] >= rect[3] - rect[2];
+    vector<double> cor;
+    for(int i = 0; i < n; i++)
+    {
+        cor.push_back(along_x ? polygon[i]->x : polygon[i]->y);
+    }
+    vector<double> sorted = cor;
+    nth_element(sorted.begin(),sorted.begin()+n/2,sorted.end());
+    double median = sorted[n/2];
+    //The vertices closest to the median
+    int k = min(n,16);
+    vector<int> candidates(n);
+    for(int i = 0; i < n; i++) candidates[i] = i;
+    partial_sort(candidates.begin(),candidates.begin()+k,candidates.end(),[&](int p,int q){ return fabs(cor[p]-median) < fabs(cor[q]-median); });
+    for(int p = 0; p < k; p++)
+    {
+        for(int q = p+1; q < k; q++)
+        {
+            int i = min(candidates[p],candidates[q]);
+            int j = max(candidates[p],candidates[q]);
+            if(min(j-i,n-(j-i)) < n/4) continue;
+            if(validDiagonal(polygon,i,j))
+            {
+                a = i;
+                b = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Calculates the area of a polygon
+ * 
+ * @param polygon The Vector of Vertices of the Polygon
+ * 
+ * Uses the same sum as IsClockwise() so the area is positive for a clockwise polygon
+ * 
+ * @return The signed area of the polygon
+*/
+double polygonArea(vector<Vertex*>& polygon)
+{
+    int n = polygon.size();
+    double sum = 0.0;
+    for(int i = 0; i < n; i++)
+    {
+        Vertex* v1 = polygon[i];
+        Vertex* v2 = polygon[(i+1)%n];
+        sum += (v2->x - v1->x)*(v2->y + v1->y);
+    }
+    return sum/2;
+}
+
+/**
+ * @brief Calculates the area of a polygon given by the coordinates read from the input
+ * 
+ * @param vertices The X and Y coordinates of the vertices
+ * @param ring The indices of the vertices of the polygon in order, NULL to use all the vertices in order
+ * 
+ * @see polygonArea()
+ * @return The signed area of the polygon, positive for a clockwise polygon
+*/
+double polygonArea(vector<pair<double,double>>& vertices,vector<int>* ring)
+{
+    int n = ring == NULL ? vertices.size() : ring->size();
+    auto at = [&](int i) { return ring == NULL ? vertices[i] : vertices[(*ring)[i]]; };
+    double sum = 0.0;
+    for(int i = 0; i < n; i++)
+    {
+        pair<double,double> v1 = at(i);
+        pair<double,double> v2 = at((i+1)%n);
+        sum += (v2.first - v1.first)*(v2.second + v1.second);
+    }
+    return sum/2;
+}
+
+/**
+ * @brief Cuts a polygon into triangles by clipping ears
+ * 
+ * @param polygon The Vector of Vertices of the Polygon in clockwise order
+ * 
+ * A vertex that is not a notch is an ear if no notch lies in or on the triangle it forms with its neighbours.
+ * Only notches can be inside such a triangle, so they are kept in a uniform grid and a check visits the cells
+ * covering the bounding box of the triangle only. This is close to O(n) unless the triangles are long and thin.
+ * If no ear is found, which only happens for degenerate polygons, the current vertex is clipped anyway.
+ * 
+ * @see isNotch() , cross()
+ * @return The triangles, each as the previous vertex, the ear and the next vertex
+*/
+vector<vector<Vertex*>> triangulate(vector<Vertex*>& polygon)
+{
+    int n = polygon.size();
+    vector<vector<Vertex*>> triangles;
+    if(n < 3) return triangles;
+    vector<int> prev(n);
+    vector<int> next(n);
+    vector<bool> notch(n);
+    vector<int> notches;
+    for(int i = 0; i < n; i++)
+    {
+        prev[i] = (i+n-1)%n;
+        next[i] = (i+1)%n;
+    }
+    for(int i = 0; i < n; i++)
+    {
+        notch[i] = isNotch(polygon[prev[i]],polygon[i],polygon[next[i]]);
+        if(notch[i]) notches.push_back(i);
+    }
+    vector<double> rect = getRectangle(polygon);
+    int side = max(1,(int)sqrt((double)notches.size()));
+    double width = max(rect[1]-rect[0],1e-300)/side;
+    double height = max(rect[3]-rect[2],1e-300)/side;
+    auto column = [&](double x) { return min(side-1,max(0,(int)((x-rect[0])/width))); };
+    auto row = [&](double y) { return min(side-1,max(0,(int)((y-rect[2])/height))); };
+    vector<vector<int>> grid(side*side);
+    for(int j : notches) grid[row(polygon[j]->y)*side + column(polygon[j]->x)].push_back(j);
+    auto isEar = [&](int i)
+    {
+        if(notch[i]) return false;
+        Vertex* a = polygon[prev[i]];
+        Vertex* b = polygon[i];
+        Vertex* c = polygon[next[i]];
+        int c1 = column(min({a->x,b->x,c->x}));
+        int c2 = column(max({a->x,b->x,c->x}));
+        int r1 = row(min({a->y,b->y,c->y}));
+        int r2 = row(max({a->y,b->y,c->y}));
+        for(int r = r1; r <= r2; r++)
+        {
+            for(int k = c1; k <= c2; k++)
+            {
+                for(int j : grid[r*side + k])
+                {
+                    //A clipped vertex is never a notch again
+                    if(!notch[j] || j == prev[i] || j == next[i]) continue;
+                    Vertex* p = polygon[j];
+                    if(cross(a,b,p) <= 0 && cross(b,c,p) <= 0 && cross(c,a,p) <= 0) return false;
+                }
+            }
+        }
+        return true;
+    };
+    int remaining = n;
+    int i = 0;
+    int misses = 0;
+    while(remaining > 3)
+    {
+        if(isEar(i) || misses > remaining)
+        {
+            int a = prev[i];
+            int c = next[i];
+            triangles.push_back({polygon[a],polygon[i],polygon[c]});
+            next[a] = c;
+            prev[c] = a;
+            notch[i] = false;
+            remaining--;
+            notch[a] = isNotch(polygon[prev[a]],polygon[a],polygon[c]);
+            notch[c] = isNotch(polygon[a],polygon[c],polygon[next[c]]);
+            i = a;
+            misses = 0;
+        }
+        else
+        {
+            i = next[i];
+            misses++;
+        }
+    }
+    triangles.push_back({polygon[prev[i]],polygon[i],polygon[next[i]]});
+    return triangles;
+}
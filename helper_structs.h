@@ -9,6 +9,7 @@
  * @date 24-03-23
 */
 
+#pragma once
 #include <bits/stdc++.h>
 
 using namespace std;
@@ -40,4 +41,51 @@ struct Edge
 struct Face
 {
     Edge* incidentEdge;/**< An Edge pointer to the incident edge in the given face*/
-};
\ No newline at end of file
+};
+/**
+ * @brief A struct representing the header of a binary DCEL snapshot
+ * 
+ * The header is followed by these sections in order, each padded to a multiple of 8 bytes
+ * - The vertices as an array of Vertex
+ * - The half edges as four 32 bit indices each, the origin vertex and the twin, previous and next half edges
+ * - The half edge of every entry of the edge list
+ * - The incident half edge of every face
+ * - The half edge of every diagonal
+ * - The LP map as the start of the list of every vertex followed by the lists
+ * - The input index of every vertex
+ * - The notch flag of every vertex as a byte
+*/
+struct SnapshotHeader
+{
+    char magic[4];/**< The characters DCEL */
+    uint32_t version;/**< The version of the format */
+    int64_t vertices;/**< The no of vertices */
+    int64_t half_edges;/**< The no of half edges */
+    int64_t edges;/**< The no of entries in the edge list */
+    int64_t faces;/**< The no of faces */
+    int64_t diagonals;/**< The no of diagonals */
+    int64_t lp;/**< The total no of entries in the LP map */
+    int64_t input_index;/**< The no of entries in the input index */
+    int64_t from;/**< The index of the first diagonal still to be merged as passed to DCEL::merge() */
+    int64_t polygons;/**< The no of polygons in the DCEL, more than one for a map layer */
+};
+
+/**
+ * @brief A struct representing a DCEL packed into arrays of indices
+ * 
+ * The arrays hold the sections of a snapshot described in SnapshotHeader, the half edges take four entries of links each.
+ * 
+ * @see DCEL::pack() , DCEL::save_snapshot() , FrozenDCEL
+*/
+struct PackedDCEL
+{
+    vector<Vertex> coordinates;/**< The vertices */
+    vector<int32_t> links;/**< The origin vertex and the twin, previous and next half edges of every half edge, -1 for NULL */
+    vector<int32_t> edges;/**< The half edge of every entry of the edge list */
+    vector<int32_t> faces;/**< The incident half edge of every face */
+    vector<int32_t> diagonals;/**< The half edge of every diagonal */
+    vector<int32_t> lp_start;/**< The start in lp of the list of every vertex, with the total at the end */
+    vector<int32_t> lp;/**< The lists of the LP map */
+    vector<int32_t> input_index;/**< The input index of every vertex */
+    vector<uint8_t> notches;/**< The notch flag of every vertex */
+};
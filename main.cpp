@@ -11,27 +11,51 @@
 #include <bits/stdc++.h>
 #include <ctime>
 #include "dcel.h"
+#include "stream.h"
+#include "server.h"
+#include "small.h"
+#include "validate.h"
+#include "rcu.h"
+#include "memory.h"
 using namespace std;
 
 /**
- * @brief The Function Splits the Polygon into Convex Polygon using Split Algorithm
+ * @brief The Function finds the Convex Polygons cut off from a Polygon by the Split Algorithm
  * 
- * @param dcel A pointer to the DCEL describing the polygon 
+ * @param vertices The vertices of the polygon in clockwise order
+ * @param budget The budget that bounds the split, NULL for no limit
+ * @param simple Set to false if the split made no progress, NULL if not needed
  * 
  * The function starts with all set of vertices and selects consecutive vertices from the start of original vertices list and forms a 
- * convex polygon by adding diagonal and then takes the rest of the polygon excluding the vertices of the newly formed convex polygon and 
+ * convex polygon and then takes the rest of the polygon excluding the vertices of the newly formed convex polygon and 
  * performs the same function on the rest of the vertices.
+ * If the budget runs out the rest of the polygon is cut by triangulate() and the path of the budget is set to PATH_TRIANGULATED.
+ * A step that cuts nothing off starts the next step one vertex further, once as many such steps as there are vertices left
+ * follow each other the loop would repeat forever, which only happens if the polygon is not simple, so the split stops there.
  * 
- * @see DCEL , DCEL::vertices , DCEL::notches , isNotch() , getRectangle() , insideRect() , insidePolygon() , ang()
- * @return void
+ * @see split() , split_layer() , isNotch() , getRectangle() , insideRect() , insidePolygon() , ang() , triangulate() , Budget
+ * @return The convex polygons, each is cut off by a diagonal between its first and last vertex, only part of them if the split made no progress
  */
-void split(DCEL* dcel)
+vector<vector<Vertex*>> split_pieces(vector<Vertex*> vertices,Budget* budget = NULL,bool* simple = NULL)
 {
-    vector<Vertex*> vertices = dcel->vertices;
     vector<vector<Vertex*>> polygons;
+    int stalled = 0;
+    if(simple != NULL) *simple = true;
     
     while(vertices.size() > 3)
     {
+        if(stalled >= (int)vertices.size())
+        {
+            if(simple != NULL) *simple = false;
+            break;
+        }
+        if(budget != NULL && !budget->spend(vertices.size()))
+        {
+            vector<vector<Vertex*>> triangles = triangulate(vertices);
+            polygons.insert(polygons.end(),triangles.begin(),triangles.end());
+            if(budget != NULL) budget->path = PATH_TRIANGULATED;
+            break;
+        }
         int n = vertices.size();
         Vertex* v1 = vertices[0];
         Vertex* v2 = vertices[1];
@@ -84,6 +108,11 @@ void split(DCEL* dcel)
             if(polygon.size() != 2)
             {
                 polygons.push_back(polygon);
+                stalled = 0;
+            }
+            else
+            {
+                stalled++;
             }
             vector<Vertex*> new_vertices;
             for(int j=polygon.size()-1;j<vertices.size();j++)
@@ -99,27 +128,248 @@ void split(DCEL* dcel)
             break;
         }
     }
- 
-    //iterate through list of polygons and add diagnol to each polygon inside DCEL.
+    return polygons;
+}
+
+/**
+ * @brief The Function Splits the Polygon into Convex Polygon using Split Algorithm
+ * 
+ * @param dcel A pointer to the DCEL describing the polygon 
+ * @param budget The budget that bounds the split, NULL for no limit
+ * 
+ * The diagonals of the convex polygons found by split_pieces() are added to the DCEL.
+ * A convex polygon is left as it is.
+ * 
+ * @see DCEL , DCEL::vertices , DCEL::isConvex() , DCEL::addDiagonals() , split_pieces() , Budget
+ * @return false if the split made no progress as the polygon is not simple, no diagonals are added then
+ */
+bool split(DCEL* dcel,Budget* budget = NULL)
+{
+    if(dcel->isConvex())
+    {
+        return true;
+    }
+    bool simple;
+    vector<vector<Vertex*>> polygons = split_pieces(dcel->vertices,budget,&simple);
+    if(!simple)
+    {
+        return false;
+    }
+
+    //add the diagonal of every polygon inside DCEL at once.
+    unordered_map<Vertex*,int> index;
+    for(int i=0;i<dcel->vertices.size();i++) index[dcel->vertices[i]] = i;
+    vector<pair<int,int>> diagonals;
     for(auto& polygon:polygons){
-        dcel->addDiagonal(polygon);
+        diagonals.push_back({index[polygon[0]],index[polygon[polygon.size()-1]]});
     }
+    dcel->addDiagonals(diagonals);
+    return true;
 }
 
 /**
- * @brief This function performs the join operation after reading the vertices from the input file
+ * @brief The Function Splits and Merges a large Polygon by cutting it into tiles that are decomposed in parallel
+ * 
+ * @param dcel A pointer to the DCEL describing the polygon 
+ * @param tiles The no of tiles the polygon is cut into
+ * 
+ * The largest tile is repeatedly cut into two by a diagonal found with findCut() till there are enough tiles.
+ * Every tile is built into its own DCEL and goes through split() and DCEL::merge() on a pool of atmost one thread per core,
+ * the threads take the next tile from a shared counter till none are left.
+ * The diagonals left in the tiles are then added to the given DCEL in one pass followed by the diagonals used to cut the tiles.
+ * Only the cutting diagonals still need to be merged, which is done by passing the returned index to DCEL::merge().
+ * 
+ * @see findCut() , split() , DCEL::merge() , DCEL::addDiagonals() , DCEL::getDiagonals()
+ * @return The index of the first cutting diagonal in the diagonal list, -1 if the split of a tile made no progress
+ */
+int split_tiles(DCEL* dcel,int tiles)
+{
+    int n = dcel->vertices.size();
+    vector<vector<int>> rings(1);
+    vector<pair<int,int>> cuts;
+    for(int i=0;i<n;i++) rings[0].push_back(i);
+    vector<bool> done(1,false);
+    while(rings.size() < tiles)
+    {
+        //Pick the largest tile that can still be cut
+        int t = -1;
+        for(int i=0;i<rings.size();i++)
+        {
+            if(!done[i] && (t == -1 || rings[i].size() > rings[t].size())) t = i;
+        }
+        if(t == -1) break;
+        vector<Vertex*> polygon;
+        for(int k : rings[t]) polygon.push_back(dcel->vertices[k]);
+        int a,b;
+        if(!findCut(polygon,a,b))
+        {
+            done[t] = true;
+            continue;
+        }
+        vector<int> ring = rings[t];
+        vector<int> first(ring.begin()+a,ring.begin()+b+1);
+        vector<int> second(ring.begin()+b,ring.end());
+        second.insert(second.end(),ring.begin(),ring.begin()+a+1);
+        cuts.push_back({ring[a],ring[b]});
+        rings[t] = first;
+        rings.push_back(second);
+        done.push_back(false);
+    }
+
+    //Decompose the tiles on a pool of threads
+    vector<vector<pair<int,int>>> diagonals(rings.size());
+    atomic<int> next(0);
+    atomic<bool> simple(true);
+    auto work = [&]()
+    {
+        for(int t = next++; t < rings.size(); t = next++)
+        {
+            DCEL tile;
+            for(int k : rings[t]) tile.addVertex(dcel->vertices[k]->x,dcel->vertices[k]->y);
+            tile.join();
+            if(!split(&tile))
+            {
+                simple = false;
+                continue;
+            }
+            tile.merge();
+            unordered_map<Vertex*,int> index;
+            for(int k=0;k<tile.vertices.size();k++) index[tile.vertices[k]] = rings[t][k];
+            for(Edge* e : tile.getDiagonals())
+            {
+                diagonals[t].push_back({index[e->twinEdge->org],index[e->org]});
+            }
+        }
+    };
+    int threads = max(1,min<int>(thread::hardware_concurrency(),rings.size()));
+    vector<thread> workers;
+    for(int w=1;w<threads;w++) workers.push_back(thread(work));
+    work();
+    for(auto& worker : workers) worker.join();
+    if(!simple)
+    {
+        return -1;
+    }
+
+    //Stitch the tiles together
+    vector<pair<int,int>> stitched;
+    for(int t=0;t<rings.size();t++)
+    {
+        stitched.insert(stitched.end(),diagonals[t].begin(),diagonals[t].end());
+    }
+    stitched.insert(stitched.end(),cuts.begin(),cuts.end());
+    dcel->addDiagonals(stitched);
+    return dcel->getDiagonals().size() - cuts.size();
+}
+
+/**
+ * @brief The Function Splits every non convex face of a map layer in place
+ * 
+ * @param dcel A pointer to the DCEL built by DCEL::build_layer()
+ * @param rings The vertices of every face in clockwise order
+ * @param faces The face of every ring
+ * @param budget The budget that bounds the split, NULL for no limit
+ * 
+ * Every ring goes through split_pieces() on its own and the diagonals are added with DCEL::addDiagonal() searching only
+ * the faces cut from the ring, as the vertices on the ring may be shared with other faces.
+ * 
+ * @see split_pieces() , DCEL::build_layer() , DCEL::addDiagonal() , input_layer()
+ * @return false if the split of a ring made no progress as it is not simple
+ */
+bool split_layer(DCEL* dcel,vector<vector<Vertex*>>& rings,vector<Face*>& faces,Budget* budget = NULL)
+{
+    for(int r=0;r<rings.size();r++)
+    {
+        vector<Vertex*>& ring = rings[r];
+        int m = ring.size();
+        bool convex = true;
+        for(int i=0;i<m && convex;i++)
+        {
+            if(isNotch(ring[(i+m-1)%m],ring[i],ring[(i+1)%m])) convex = false;
+        }
+        if(convex) continue;
+        unordered_map<Vertex*,int> position;
+        for(int i=0;i<m;i++) position[ring[i]] = i;
+        set<Face*> scope = {faces[r]};
+        bool simple;
+        vector<vector<Vertex*>> polygons = split_pieces(ring,budget,&simple);
+        if(!simple)
+        {
+            return false;
+        }
+        for(auto& polygon : polygons)
+        {
+            //Skip pieces closed by an edge of the ring
+            int offset = (position[polygon[polygon.size()-1]] - position[polygon[0]] + m)%m;
+            if(offset <= 1 || offset == m-1) continue;
+            dcel->addDiagonal(polygon,scope);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief This function builds the DCEL of a polygon and performs the join operation
  * 
  * @param dcel A pointer to the DCEL data structure
- * @param file_name The file name of the input file
+ * @param mpl The X and Y coordinates of the vertices, simplified in place if a tolerance is given
+ * @param tolerance The tolerance used to simplify the input, a negative value disables simplification
  * 
- * The Function reads the file and initializes the vertices array
+ * If a tolerance is given, duplicate and collinear vertices are removed before the DCEL is built
  * It then checks if points are clockwise then adds them from the start
  * If given in anticlockwise appends in reverse order
+ * The index of every added vertex in the input is stored in DCEL::input_index
+ * 
+ * @see simplify() , IsClockwise() , DCEL::addVertex() , DCEL::join()
+ * @return void
+*/
+void build_polygon(DCEL * dcel,vector<pair<double,double>>& mpl,double tolerance = -1)
+{
+    int n = mpl.size();
+    vector<int> index;
+    if(tolerance >= 0)
+    {
+        index = simplify(mpl,tolerance);
+    }
+    else
+    {
+        for(int i=0;i<n;i++) index.push_back(i);
+    }
+    bool dir = IsClockwise(mpl);
+    if(!dir)
+    {
+        for(int i=mpl.size()-1;i>=0;i--)
+        {
+            dcel->addVertex(mpl[i].first,mpl[i].second);
+            dcel->input_index.push_back(index[i]);
+        }
+    }
+    else
+    {
+        for(int i=0;i<mpl.size();i++)
+        {
+            dcel->addVertex(mpl[i].first,mpl[i].second);
+            dcel->input_index.push_back(index[i]);
+        }
+    }
+    dcel->join();
+}
+
+/**
+ * @brief This function performs the join operation after reading the vertices from the input file
  * 
- * @see IsClockwise() , DCEL::addVertex() , DCEL::join()
+ * @param dcel A pointer to the DCEL data structure
+ * @param file_name The file name of the input file
+ * @param tolerance The tolerance used to simplify the input, a negative value disables simplification
+ * @param area The variable into which the area of the polygon as read from the file is written, can be NULL
+ * @param perimeter The variable into which the perimeter of the polygon as read from the file is written, can be NULL
+ * 
+ * The Function reads the file and builds the DCEL from the vertices
+ * 
+ * @see build_polygon()
  * @return n the no of coordinates of the polygon
 */
-int input_file(DCEL * dcel,string file_name)
+int input_file(DCEL * dcel,string file_name,double tolerance = -1,double* area = NULL,double* perimeter = NULL)
 {
     file_name+=".txt";
     ifstream fin(file_name);
@@ -133,47 +383,364 @@ int input_file(DCEL * dcel,string file_name)
         fin>>x>>y;
         mpl.push_back({x,y});
     }
-    bool dir = IsClockwise(mpl);
-    if(!dir)
+    if(area != NULL) *area = fabs(polygonArea(mpl));
+    if(perimeter != NULL)
     {
-        for(int i=mpl.size()-1;i>=0;i--)
-        {
-            dcel->addVertex(mpl[i].first,mpl[i].second);
-        }
+        *perimeter = 0;
+        for(int i=0;i<n;i++) *perimeter += hypot(mpl[(i+1)%n].first - mpl[i].first,mpl[(i+1)%n].second - mpl[i].second);
+    }
+    build_polygon(dcel,mpl,tolerance);
+    return n;
+}
+
+/**
+ * @brief This function reads a map layer and builds all its faces into one DCEL
+ * 
+ * @param dcel A pointer to the DCEL data structure
+ * @param file_name The file name of the input file
+ * @param rings The vector into which the vertices of every face are written in clockwise order
+ * @param faces The vector into which the face of every ring is written
+ * @param area The variable into which the total area of the faces as read from the file is written, can be NULL
+ * 
+ * The file has the no of vertices followed by their X and Y coordinates and then the no of faces
+ * followed by every face as its no of vertices and their indices, in any orientation.
+ * A vertex shared by faces is given once and used by index in all of them.
+ * 
+ * @see DCEL::build_layer() , split_layer()
+ * @return n the no of vertices of the layer
+*/
+int input_layer(DCEL * dcel,string file_name,vector<vector<Vertex*>>& rings,vector<Face*>& faces,double* area = NULL)
+{
+    file_name+=".txt";
+    ifstream fin(file_name);
+    int n;
+    fin>>n;
+    vector<pair<double,double>> points;
+    for(int i=0;i<n;i++)
+    {
+        double x;
+        double y;
+        fin>>x>>y;
+        points.push_back({x,y});
+    }
+    int f;
+    fin>>f;
+    vector<vector<int>> index(f);
+    for(int i=0;i<f;i++)
+    {
+        int m;
+        fin>>m;
+        index[i].resize(m);
+        for(int j=0;j<m;j++) fin>>index[i][j];
+    }
+    if(area != NULL)
+    {
+        *area = 0;
+        for(auto& ring : index) *area += fabs(polygonArea(points,&ring));
+    }
+    faces = dcel->build_layer(points,index);
+    rings.clear();
+    for(auto& ring : index)
+    {
+        rings.push_back(vector<Vertex*>());
+        for(int k : ring) rings.back().push_back(dcel->vertices[k]);
+    }
+    return n;
+}
+
+/**
+ * @brief This function decomposes one polygon for the server, reusing the given DCEL
+ * 
+ * @param dcel A pointer to the DCEL data structure, cleared before use
+ * @param mpl The X and Y coordinates of the vertices
+ * @param tolerance The tolerance used to simplify the input, a negative value disables simplification
+ * @param pieces The vector into which the input indices of the vertices of every convex piece are written
+ * @param budget The budget that bounds split() and DCEL::merge(), NULL for no limit
+ * 
+ * Convex and small polygons are decomposed by decompose_small() without building the DCEL, within the same budget.
+ * 
+ * @see simplify() , decompose_small() , build_polygon() , split() , DCEL::merge() , DCEL::getFaces() , PolygonServer , Budget
+ * @return false if the polygon has less than three vertices or was found not to be simple
+*/
+bool decompose(DCEL* dcel,vector<pair<double,double>>& mpl,double tolerance,vector<vector<int>>& pieces,Budget* budget = NULL)
+{
+    dcel->clear();
+    vector<int> original;
+    if(tolerance >= 0)
+    {
+        original = simplify(mpl,tolerance);
     }
     else
     {
-        for(int i=0;i<mpl.size();i++)
+        for(int i=0;i<mpl.size();i++) original.push_back(i);
+    }
+    if(mpl.size() < 3)
+    {
+        return false;
+    }
+    bool valid = true;
+    if(!decompose_small(mpl,pieces,budget,&valid))
+    {
+        build_polygon(dcel,mpl);
+        if(!split(dcel,budget))
         {
-            dcel->addVertex(mpl[i].first,mpl[i].second);
+            return false;
+        }
+        dcel->merge(0,budget);
+        unordered_map<Vertex*,int> index;
+        for(int i=0;i<dcel->vertices.size();i++) index[dcel->vertices[i]] = dcel->input_index[i];
+        for(Face* face : dcel->getFaces())
+        {
+            vector<int> piece;
+            Edge* curr = face->incidentEdge;
+            do {
+                piece.push_back(index[curr->org]);
+                curr = curr->next;
+            }while(curr != face->incidentEdge);
+            pieces.push_back(piece);
         }
     }
-    dcel->join();
-    return n;
+    if(!valid)
+    {
+        return false;
+    }
+    for(auto& piece : pieces)
+    {
+        for(int& k : piece) k = original[k];
+    }
+    return true;
 }
 
 /**
  * @brief The Main Function of the Program
  * 
+ * @param argc The no of command line arguments
+ * @param argv The command line arguments
+ * 
  * It handles all the file reading part and also has initializations
  * It also has the timing analysis related code
  * It writes into 3 output files one just by plotting points, the second one just after splitting and third after merging
  * Writes into a text file that has all the timings for different inputs
  * 
- * @see input_file() , DCEL::merge() , split()
+ * The following options are accepted
+ * - -s tolerance : simplify the input with the given tolerance before building the DCEL
+ * - --stream file : split the polygon in the given binary file without loading it and write the pieces to output_stream.txt
+ * - -w window : the maximum no of vertices in a piece in the streaming mode, 0 for no limit
+ * - -c bytes : the no of bytes of the input read before they are released in the streaming mode
+ * - -t tiles : cut the polygon into the given no of tiles that are split and merged in parallel
+ * - --save name : write a binary snapshot of the DCEL after splitting into name.dcel
+ * - --load name : load the snapshot name.dcel instead of reading and splitting the input, then merge it
+ * - --serve : keep running and decompose the polygons sent on stdin as described in protocol.h, replying on stdout
+ * - --socket path : like --serve but listen on a Unix domain socket at the given path
+ * - --validate : check the final decomposition against the area of the input and print the result to stderr, the exit code is 2 if it is invalid,
+ *   a loaded snapshot has no input so only its faces and links are checked
+ * - --layer name : read a map layer from name.txt instead of the input file and decompose all its faces in one DCEL
+ * - --budget-ms ms : stop splitting or merging after the given time, for the server this applies to every request
+ * - --budget-work units : stop splitting or merging after the given no of work units, the path taken is printed to stderr
+ * - --rcu-stress versions : publish the final DCEL the given no of times while reader threads walk it and print the result to stderr,
+ *   the exit code is 2 if a reader saw a broken version or a version was not freed
+ * - --memory : append the heap memory used by every phase and the size of the parts of the DCEL as a line of JSON to memory.jsonl
+ * 
+ * @see input_file() , DCEL::merge() , split() , split_tiles() , StreamSplitter , DCEL::save_snapshot() , DCEL::load_snapshot() , PolygonServer , validate() , stress_published() , MemoryReport , input_layer() , split_layer() , Budget
  * @return 0 for successful execution of the function
 */
-int main()
+int main(int argc,char* argv[])
 {
+    double tolerance = -1;
+    string stream_file = "";
+    long window = 0;
+    size_t chunk = 1<<20;
+    int tiles = 1;
+    string save_file = "";
+    string load_file = "";
+    bool serve = false;
+    string socket_path = "";
+    bool check = false;
+    int stress_versions = 0;
+    bool memory = false;
+    string layer_file = "";
+    double budget_ms = -1;
+    long long budget_work = -1;
+    for(int i=1;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg == "-s" && i+1 < argc) tolerance = atof(argv[++i]);
+        else if(arg == "--stream" && i+1 < argc) stream_file = argv[++i];
+        else if(arg == "-w" && i+1 < argc) window = atol(argv[++i]);
+        else if(arg == "-c" && i+1 < argc) chunk = atol(argv[++i]);
+        else if(arg == "-t" && i+1 < argc) tiles = atoi(argv[++i]);
+        else if(arg == "--save" && i+1 < argc) save_file = argv[++i];
+        else if(arg == "--load" && i+1 < argc) load_file = argv[++i];
+        else if(arg == "--serve") serve = true;
+        else if(arg == "--socket" && i+1 < argc) socket_path = argv[++i];
+        else if(arg == "--validate") check = true;
+        else if(arg == "--rcu-stress" && i+1 < argc) stress_versions = atoi(argv[++i]);
+        else if(arg == "--memory")
+        {
+            memory = true;
+            memory_tracking = true;
+        }
+        else if(arg == "--layer" && i+1 < argc) layer_file = argv[++i];
+        else if(arg == "--budget-ms" && i+1 < argc) budget_ms = atof(argv[++i]);
+        else if(arg == "--budget-work" && i+1 < argc) budget_work = atoll(argv[++i]);
+    }
+
+    if(serve || socket_path != "")
+    {
+        DCEL workspace;
+        PolygonServer server;
+        auto handle = [&](vector<pair<double,double>>& polygon,vector<vector<int>>& pieces) -> uint32_t
+        {
+            Budget budget(budget_ms,budget_work);
+            if(!decompose(&workspace,polygon,tolerance,pieces,&budget)) return STATUS_INVALID;
+            if(budget.path == PATH_SPLIT_ONLY) return STATUS_SPLIT_ONLY;
+            if(budget.path == PATH_TRIANGULATED) return STATUS_TRIANGULATED;
+            return STATUS_OK;
+        };
+        if(socket_path != "")
+        {
+            if(!server.listen_socket(socket_path,handle))
+            {
+                cerr<<"Could not listen on "<<socket_path<<endl;
+                return 1;
+            }
+        }
+        else
+        {
+            server.serve(0,1,handle);
+            server.latency.report(cerr,"server");
+        }
+        return 0;
+    }
+
     clock_t starting_time = clock();
 
+    if(stream_file != "")
+    {
+        StreamSplitter splitter;
+        if(!splitter.split(stream_file,"output_stream.txt",window,chunk))
+        {
+            if(!splitter.simple) cerr<<"The polygon in "<<stream_file<<" is not simple"<<endl;
+            else cerr<<"Could not read "<<stream_file<<endl;
+            return 1;
+        }
+        clock_t ending_time = clock();
+        double elapsed_time = static_cast<double>(ending_time-starting_time)/CLOCKS_PER_SEC;
+        cout<<splitter.pieces<<" pieces in "<<elapsed_time<<" s"<<endl;
+        return 0;
+    }
+
+    MemoryReport memory_report;
     DCEL* dcel = new DCEL();
-    int n = input_file(dcel,"input");
-    dcel->output_file("output1");
-    split(dcel);
-    dcel->output_file("output2");
-    dcel->merge();
+    int n;
+    int from = 0;
+    //The no of polygons in the DCEL, one for every ring of a map layer
+    int polygons = 1;
+    vector<vector<Vertex*>> rings;
+    vector<Face*> faces;
+    //The area of the input before it is simplified or built, NAN when it is not known
+    double input_area = NAN;
+    double perimeter = 0;
+    bool bounded = budget_ms >= 0 || budget_work >= 0;
+    Budget budget;
+    if(load_file != "")
+    {
+        memory_report.begin("load_snapshot");
+        if(!dcel->load_snapshot(load_file,&from,&polygons))
+        {
+            cerr<<"Could not load "<<load_file<<".dcel"<<endl;
+            return 1;
+        }
+        n = dcel->vertices.size();
+        memory_report.end();
+        budget = Budget(budget_ms,budget_work);
+    }
+    else if(layer_file != "")
+    {
+        memory_report.begin("input_file");
+        n = input_layer(dcel,layer_file,rings,faces,&input_area);
+        polygons = max<int>(1,rings.size());
+        memory_report.end();
+        memory_report.begin("output");
+        dcel->output_file("output1");
+        memory_report.end();
+        memory_report.begin("split");
+        budget = Budget(budget_ms,budget_work);
+        bool simple = split_layer(dcel,rings,faces,bounded ? &budget : NULL);
+        memory_report.end();
+        if(!simple)
+        {
+            cerr<<"A face of "<<layer_file<<" is not simple"<<endl;
+            return 1;
+        }
+        memory_report.begin("output");
+        dcel->output_file("output2");
+        memory_report.end();
+    }
+    else
+    {
+        memory_report.begin("input_file");
+        n = input_file(dcel,"input",tolerance,&input_area,&perimeter);
+        memory_report.end();
+        memory_report.begin("output");
+        dcel->output_file("output1");
+        memory_report.end();
+        memory_report.begin("split");
+        budget = Budget(budget_ms,budget_work);
+        bool simple;
+        if(tiles > 1)
+        {
+            from = split_tiles(dcel,tiles);
+            simple = from >= 0;
+        }
+        else
+        {
+            simple = split(dcel,bounded ? &budget : NULL);
+        }
+        memory_report.end();
+        if(!simple)
+        {
+            cerr<<"The polygon is not simple"<<endl;
+            return 1;
+        }
+        memory_report.begin("output");
+        dcel->output_file("output2");
+        memory_report.end();
+    }
+    if(save_file != "")
+    {
+        dcel->save_snapshot(save_file,from,polygons);
+    }
+    memory_report.begin("merge");
+    dcel->merge(from,bounded ? &budget : NULL);
+    memory_report.end();
+    memory_report.begin("output");
     dcel->output_file("output3");
+    memory_report.end();
+    int status = 0;
+    if(bounded)
+    {
+        cerr<<"path "<<path_name(budget.path)<<endl;
+    }
+    if(check)
+    {
+        //A simplified polygon stays within the tolerance of the input all along its boundary
+        double area_error = tolerance > 0 ? tolerance*perimeter : 0;
+        ValidationReport report = validate(dcel,input_area,area_error,polygons);
+        print_report(cerr,report);
+        if(!report.valid) status = 2;
+    }
+    if(stress_versions > 0)
+    {
+        StressReport report = stress_published(*dcel,stress_versions);
+        print_report(cerr,report);
+        if(!report.valid) status = 2;
+    }
+    if(memory)
+    {
+        memory_report.set_footprint(dcel->memory_usage());
+        memory_report.write("memory.jsonl",n);
+    }
 
     clock_t ending_time = clock();
     double elapsed_time = static_cast<double>(ending_time-starting_time)/CLOCKS_PER_SEC;
@@ -184,5 +751,5 @@ int main()
         optfile<<n<<" "<<elapsed_time<<endl;
         optfile.close();
     }
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+/**
+ * @file memory.h
+ * @brief This Header implements the tracking of heap memory used by every phase of the program
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+ *
+ * The global operator new and operator delete are replaced so every allocation made through them can be counted.
+ * Counting is off till memory_tracking is set, till then the replaced functions only call malloc and free.
+ * Every thread counts into its own slot so the threads do not contend on the counters, the slots are summed by MemoryReport.
+ * This Header must only be included by the file that has the main function.
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include <malloc.h>
+
+using namespace std;
+
+#define MEMORY_SLOTS 64/**< The no of counter slots, threads beyond this share a slot */
+
+/**
+ * @brief A struct representing the counters of one slot, updated by every allocation of the threads using the slot
+ *
+ * The counters are atomic since a slot can be shared and is read by MemoryReport while the threads run.
+ * A block freed by another thread than the one that allocated it is subtracted from the slot of the freeing thread,
+ * so only the sum of live over all slots is meaningful.
+*/
+struct alignas(64) MemoryCounters
+{
+    atomic<long long> live;/**< The no of bytes currently allocated */
+    atomic<long long> peak;/**< The largest value of live since the last reset */
+    atomic<long long> allocations;/**< The no of allocations made */
+    atomic<long long> frees;/**< The no of allocations freed */
+};
+
+atomic<bool> memory_tracking(false);/**< True once counting is turned on, set before the phases to be measured */
+MemoryCounters memory_counters[MEMORY_SLOTS];/**< The counters of every slot, zero before any allocation */
+atomic<int> memory_next_slot(0);/**< The slot given to the next thread that allocates */
+thread_local int memory_slot = -1;/**< The slot of the current thread, -1 till its first counted allocation */
+
+/**
+ * @brief Returns the counters of the current thread, giving it a slot on its first call
+*/
+inline MemoryCounters& memory_thread_counters()
+{
+    if(memory_slot == -1) memory_slot = memory_next_slot.fetch_add(1,memory_order_relaxed)%MEMORY_SLOTS;
+    return memory_counters[memory_slot];
+}
+
+/**
+ * @brief Replaces the global allocation function to count the allocated bytes
+ *
+ * The size counted is the usable size of the block returned by malloc.
+ *
+ * @param size The no of bytes requested
+ * @return A pointer to the allocated block
+*/
+void* operator new(size_t size)
+{
+    void* p = malloc(size == 0 ? 1 : size);
+    if(p == NULL) throw bad_alloc();
+    if(!memory_tracking.load(memory_order_relaxed)) return p;
+    MemoryCounters& c = memory_thread_counters();
+    long long live = c.live.fetch_add(malloc_usable_size(p),memory_order_relaxed) + malloc_usable_size(p);
+    c.allocations.fetch_add(1,memory_order_relaxed);
+    if(live > c.peak.load(memory_order_relaxed)) c.peak.store(live,memory_order_relaxed);
+    return p;
+}
+
+/**
+ * @brief Replaces the global deallocation function to count the freed bytes
+ *
+ * It is kept out of line so the compiler does not pair the free() inside it with the operator new of the caller.
+ * A block allocated before counting was turned on is subtracted as well, which is a few bytes from the setup of the program.
+ *
+ * @param p A pointer returned by operator new
+ * @return void
+*/
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    if(p == NULL) return;
+    if(memory_tracking.load(memory_order_relaxed))
+    {
+        MemoryCounters& c = memory_thread_counters();
+        c.live.fetch_sub(malloc_usable_size(p),memory_order_relaxed);
+        c.frees.fetch_add(1,memory_order_relaxed);
+    }
+    free(p);
+}
+
+/**
+ * @brief The array and sized forms are replaced as well so no allocation bypasses the counters
+*/
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p,size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p,size_t) noexcept
+{
+    operator delete(p);
+}
+
+/**
+ * @brief A struct representing the memory used by one phase
+*/
+struct MemoryPhase
+{
+    string name;/**< The name of the phase */
+    long long live_start;/**< The bytes allocated when the phase started */
+    long long live_end;/**< The bytes allocated when the phase ended */
+    long long peak;/**< The largest no of bytes allocated during the phase */
+    long long allocations;/**< The no of allocations made during the phase */
+    long long frees;/**< The no of allocations freed during the phase */
+};
+
+/**
+ * @brief A Class that records the memory used by the phases of a run and writes them as JSON
+*/
+class MemoryReport
+{
+    private:
+    vector<MemoryPhase> phases;/**< The finished phases */
+    MemoryPhase current;/**< The phase in progress */
+    vector<pair<string,size_t>> footprint;/**< The estimated size of the parts of the DCEL */
+
+    /**
+     * @brief Adds up one counter over all the slots
+     *
+     * @param counter The member of MemoryCounters to add up
+     * @return The total
+    */
+    long long total(atomic<long long> MemoryCounters::* counter)
+    {
+        long long sum = 0;
+        for(int i = 0; i < MEMORY_SLOTS; i++) sum += (memory_counters[i].*counter).load();
+        return sum;
+    }
+
+    public:
+    /**
+     * @brief Starts a phase, the peak of every slot is reset to its bytes allocated now
+     *
+     * @param name The name of the phase
+     * @return void
+    */
+    void begin(string name)
+    {
+        current.name = name;
+        for(int i = 0; i < MEMORY_SLOTS; i++) memory_counters[i].peak.store(memory_counters[i].live.load());
+        current.live_start = total(&MemoryCounters::live);
+        current.allocations = total(&MemoryCounters::allocations);
+        current.frees = total(&MemoryCounters::frees);
+    }
+
+    /**
+     * @brief Ends the phase started by begin()
+     *
+     * The peak of the phase is the sum of the peaks of the slots, which is exact for one thread
+     * and an upper bound when several threads allocate during the phase.
+     *
+     * @return void
+    */
+    void end()
+    {
+        current.live_end = total(&MemoryCounters::live);
+        current.peak = total(&MemoryCounters::peak);
+        current.allocations = total(&MemoryCounters::allocations) - current.allocations;
+        current.frees = total(&MemoryCounters::frees) - current.frees;
+        phases.push_back(current);
+    }
+
+    /**
+     * @brief Stores the estimated size of the parts of a DCEL to be written with the phases
+     *
+     * @param parts The name and size in bytes of every part
+     * @see DCEL::memory_usage()
+     * @return void
+    */
+    void set_footprint(vector<pair<string,size_t>> parts)
+    {
+        footprint = parts;
+    }
+
+    /**
+     * @brief Appends the report as one line of JSON to the given file
+     *
+     * @param file_name The name of the file
+     * @param n The no of vertices of the polygon
+     * @return void
+    */
+    void write(string file_name,int n)
+    {
+        ofstream fout(file_name,ios_base::app);
+        fout<<"{\"n\":"<<n<<",\"phases\":[";
+        for(int i = 0; i < phases.size(); i++)
+        {
+            MemoryPhase& p = phases[i];
+            if(i > 0) fout<<",";
+            fout<<"{\"name\":\""<<p.name<<"\",\"live_start\":"<<p.live_start<<",\"live_end\":"<<p.live_end
+                <<",\"peak\":"<<p.peak<<",\"allocations\":"<<p.allocations<<",\"frees\":"<<p.frees<<"}";
+        }
+        fout<<"],\"dcel\":{";
+        for(int i = 0; i < footprint.size(); i++)
+        {
+            if(i > 0) fout<<",";
+            fout<<"\""<<footprint[i].first<<"\":"<<footprint[i].second;
+        }
+        fout<<"}}"<<endl;
+    }
+};
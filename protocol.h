@@ -0,0 +1,268 @@
+/**
+ * @file protocol.h
+ * @brief This Header implements the binary protocol used between the decomposition server and its clients
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+ *
+ * Every message is a frame made of its length in bytes as a 32 bit integer followed by the payload.
+ * - A request payload is the no of vertices as a 32 bit integer followed by the X and Y coordinates of every vertex as doubles
+ * - A reply payload is a status, the no of pieces and then every piece as the no of its vertices followed by their indices in the request, all 32 bit integers
+ * - The status is one of the STATUS values, the pieces are a valid decomposition for every status except STATUS_INVALID
+ * - An empty request asks the server to stop
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define MAX_FRAME (1u<<30)/**< The largest payload accepted in a frame */
+#define FRAME_CHUNK (1u<<20)/**< The no of bytes of a payload read at a time, so memory only grows with the bytes that arrived */
+#define STATUS_OK 0/**< The polygon was split and merged in full */
+#define STATUS_INVALID 1/**< The request could not be decoded, the polygon has less than three vertices or was found not to be simple */
+#define STATUS_SPLIT_ONLY 2/**< The budget ran out while merging, some diagonals were not checked */
+#define STATUS_TRIANGULATED 3/**< The budget ran out while splitting, the rest of the polygon was triangulated */
+
+/**
+ * @brief Reads exactly the given no of bytes from a file descriptor
+ *
+ * @param fd The file descriptor
+ * @param buf The buffer to read into
+ * @param n The no of bytes
+ * @return false if the stream ended or failed before all bytes were read
+*/
+bool read_full(int fd,void* buf,size_t n)
+{
+    char* p = (char*)buf;
+    while(n > 0)
+    {
+        ssize_t got = read(fd,p,n);
+        if(got < 0 && errno == EINTR) continue;
+        if(got <= 0) return false;
+        p += got;
+        n -= got;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes exactly the given no of bytes to a file descriptor
+ *
+ * @param fd The file descriptor
+ * @param buf The buffer to write from
+ * @param n The no of bytes
+ * @return false if the write failed
+*/
+bool write_full(int fd,const void* buf,size_t n)
+{
+    const char* p = (const char*)buf;
+    while(n > 0)
+    {
+        ssize_t put = write(fd,p,n);
+        if(put < 0 && errno == EINTR) continue;
+        if(put <= 0) return false;
+        p += put;
+        n -= put;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads one frame
+ *
+ * @param fd The file descriptor
+ * @param payload The vector into which the payload is read, its capacity is reused
+ *
+ * The payload is read in steps of FRAME_CHUNK bytes and the vector only grows before each step,
+ * so a length that is not followed by the data cannot make it allocate the whole frame.
+ *
+ * @return false if the stream ended or the frame is too large
+*/
+bool read_frame(int fd,vector<char>& payload)
+{
+    uint32_t length;
+    if(!read_full(fd,&length,sizeof(length)) || length > MAX_FRAME) return false;
+    payload.clear();
+    for(size_t done = 0; done < length; )
+    {
+        size_t step = min<size_t>(FRAME_CHUNK,length - done);
+        payload.resize(done + step);
+        if(!read_full(fd,payload.data() + done,step)) return false;
+        done += step;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes one frame
+ *
+ * @param fd The file descriptor
+ * @param payload The payload
+ * @return false if the write failed
+*/
+bool write_frame(int fd,const vector<char>& payload)
+{
+    uint32_t length = payload.size();
+    return write_full(fd,&length,sizeof(length)) && write_full(fd,payload.data(),length);
+}
+
+/**
+ * @brief Encodes a polygon into a request payload
+ *
+ * @param polygon The X and Y coordinates of the vertices
+ * @param payload The vector into which the payload is written
+ * @return void
+*/
+void encode_polygon(vector<pair<double,double>>& polygon,vector<char>& payload)
+{
+    uint32_t n = polygon.size();
+    payload.resize(sizeof(n) + n*2*sizeof(double));
+    char* p = payload.data();
+    memcpy(p,&n,sizeof(n));
+    p += sizeof(n);
+    for(auto& v : polygon)
+    {
+        memcpy(p,&v.first,sizeof(double));
+        memcpy(p+sizeof(double),&v.second,sizeof(double));
+        p += 2*sizeof(double);
+    }
+}
+
+/**
+ * @brief Decodes a request payload into a polygon
+ *
+ * @param payload The payload
+ * @param polygon The vector into which the coordinates are written
+ * @return false if the payload is malformed
+*/
+bool decode_polygon(vector<char>& payload,vector<pair<double,double>>& polygon)
+{
+    uint32_t n;
+    if(payload.size() < sizeof(n)) return false;
+    memcpy(&n,payload.data(),sizeof(n));
+    if(payload.size() != sizeof(n) + (size_t)n*2*sizeof(double)) return false;
+    polygon.resize(n);
+    const char* p = payload.data() + sizeof(n);
+    for(uint32_t i = 0; i < n; i++)
+    {
+        memcpy(&polygon[i].first,p,sizeof(double));
+        memcpy(&polygon[i].second,p+sizeof(double),sizeof(double));
+        p += 2*sizeof(double);
+    }
+    return true;
+}
+
+/**
+ * @brief Encodes the pieces of a decomposition into a reply payload
+ *
+ * @param status The STATUS value of the reply
+ * @param pieces The indices of the vertices of every piece
+ * @param payload The vector into which the payload is written
+ * @return void
+*/
+void encode_pieces(uint32_t status,vector<vector<int>>& pieces,vector<char>& payload)
+{
+    payload.clear();
+    auto put = [&](uint32_t value)
+    {
+        char* p = (char*)&value;
+        payload.insert(payload.end(),p,p+sizeof(value));
+    };
+    put(status);
+    put(pieces.size());
+    for(auto& piece : pieces)
+    {
+        put(piece.size());
+        for(int k : piece) put(k);
+    }
+}
+
+/**
+ * @brief Decodes a reply payload into the pieces of a decomposition
+ *
+ * @param payload The payload
+ * @param status The status of the reply
+ * @param pieces The vector into which the pieces are written
+ * @return false if the payload is malformed
+*/
+bool decode_pieces(vector<char>& payload,uint32_t& status,vector<vector<int>>& pieces)
+{
+    size_t at = 0;
+    auto get = [&](uint32_t& value)
+    {
+        if(at + sizeof(value) > payload.size()) return false;
+        memcpy(&value,payload.data()+at,sizeof(value));
+        at += sizeof(value);
+        return true;
+    };
+    uint32_t count;
+    if(!get(status) || !get(count)) return false;
+    pieces.assign(count,vector<int>());
+    for(auto& piece : pieces)
+    {
+        uint32_t k;
+        if(!get(k)) return false;
+        for(uint32_t i = 0; i < k; i++)
+        {
+            uint32_t v;
+            if(!get(v)) return false;
+            piece.push_back(v);
+        }
+    }
+    return at == payload.size();
+}
+
+/**
+ * @brief A Class that keeps the latest request latencies and reports their percentiles
+*/
+class LatencyTracker
+{
+    private:
+    vector<double> samples;/**< The latest latencies in milliseconds, used as a ring buffer */
+    size_t next;/**< The position of the next sample in the ring buffer */
+    size_t limit;/**< The no of samples kept */
+    public:
+    long count;/**< The no of samples added so far */
+
+    public:
+    LatencyTracker(size_t limit_samples = 1<<16)
+    {
+        next = 0;
+        limit = limit_samples;
+        count = 0;
+    }
+
+    /**
+     * @brief Adds a latency sample
+     *
+     * @param ms The latency in milliseconds
+     * @return void
+    */
+    void add(double ms)
+    {
+        if(samples.size() < limit) samples.push_back(ms);
+        else samples[next] = ms;
+        next = (next + 1) % limit;
+        count++;
+    }
+
+    /**
+     * @brief Writes the p50, p90, p99 and maximum of the kept samples
+     *
+     * @param out The stream to write into
+     * @param label The label printed before the percentiles
+     * @return void
+    */
+    void report(ostream& out,string label)
+    {
+        if(samples.empty()) return;
+        vector<double> sorted = samples;
+        sort(sorted.begin(),sorted.end());
+        auto at = [&](double q) { return sorted[min(sorted.size()-1,(size_t)(q*sorted.size()))]; };
+        out<<label<<" requests "<<count<<" p50 "<<at(0.5)<<" ms p90 "<<at(0.9)<<" ms p99 "<<at(0.99)<<" ms max "<<sorted.back()<<" ms"<<endl;
+    }
+};
@@ -0,0 +1,385 @@
+/**
+ * @file rcu.h
+ * @brief This Header implements immutable snapshots of a DCEL and their publishing to concurrent readers
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+ *
+ * A finished DCEL is frozen into a FrozenDCEL which is never changed, so any no of threads can walk it without locks.
+ * Writers swap in new versions through a Published pointer in the style of RCU and old versions are freed with
+ * epoch based reclamation once every reader that could see them has finished.
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include "dcel.h"
+
+using namespace std;
+
+#define RCU_READERS 128/**< The largest no of readers that can be inside a Published pointer at once */
+
+/**
+ * @brief A Class representing a DCEL frozen into compact arrays that are never changed
+ *
+ * The arrays are the ones written to a snapshot, so vertices, half edges and faces are numbered by their index in them.
+ * All the functions only read, so a FrozenDCEL can be shared by threads without any locking.
+ *
+ * @see PackedDCEL , DCEL::pack() , Published
+*/
+class FrozenDCEL
+{
+    private:
+    const PackedDCEL packed;/**< The arrays of the DCEL */
+
+    public:
+    /**
+     * @brief Freezes the current state of a DCEL, the DCEL can be changed or freed afterwards
+     *
+     * @param dcel The DCEL to freeze
+    */
+    FrozenDCEL(DCEL& dcel) : packed(dcel.pack())
+    {
+    }
+
+    /**
+     * @brief Returns the no of vertices
+    */
+    int vertex_count() const
+    {
+        return packed.coordinates.size();
+    }
+
+    /**
+     * @brief Returns the no of faces
+    */
+    int face_count() const
+    {
+        return packed.faces.size();
+    }
+
+    /**
+     * @brief Returns the no of diagonals
+    */
+    int diagonal_count() const
+    {
+        return packed.diagonals.size();
+    }
+
+    /**
+     * @brief Returns the vertex with the given index
+    */
+    const Vertex& vertex(int v) const
+    {
+        return packed.coordinates[v];
+    }
+
+    /**
+     * @brief Returns the index in the input of the vertex with the given index
+    */
+    int input_index(int v) const
+    {
+        return v < (int)packed.input_index.size() ? packed.input_index[v] : v;
+    }
+
+    /**
+     * @brief Returns the origin vertex of a half edge
+    */
+    int origin(int h) const
+    {
+        return packed.links[4*h];
+    }
+
+    /**
+     * @brief Returns the twin of a half edge
+    */
+    int twin(int h) const
+    {
+        return packed.links[4*h+1];
+    }
+
+    /**
+     * @brief Returns the previous half edge in the face of a half edge, -1 if there is none
+    */
+    int prev(int h) const
+    {
+        return packed.links[4*h+2];
+    }
+
+    /**
+     * @brief Returns the next half edge in the face of a half edge, -1 if there is none
+    */
+    int next(int h) const
+    {
+        return packed.links[4*h+3];
+    }
+
+    /**
+     * @brief Returns the incident half edge of a face
+    */
+    int face_edge(int f) const
+    {
+        return packed.faces[f];
+    }
+
+    /**
+     * @brief Returns the half edge of a diagonal
+    */
+    int diagonal(int d) const
+    {
+        return packed.diagonals[d];
+    }
+
+    /**
+     * @brief Returns the vertices of a face in clockwise order
+     *
+     * @param f The index of the face
+     * @return The indices of the vertices
+    */
+    vector<int> face(int f) const
+    {
+        vector<int> piece;
+        int start = face_edge(f);
+        int curr = start;
+        do {
+            piece.push_back(origin(curr));
+            curr = next(curr);
+        }while(curr != start && curr != -1);
+        return piece;
+    }
+};
+
+/**
+ * @brief A Class representing a pointer to the current version of an immutable object shared by readers and writers
+ *
+ * @tparam T The type of the object, FrozenDCEL for decompositions
+ *
+ * Readers hold a Reader while they use the object, it takes a slot and stores the global epoch in it before loading the pointer.
+ * publish() swaps the pointer and moves the epoch on, the old version is retired with the new epoch and freed by reclaim()
+ * once every slot in use holds at least that epoch, as a reader with an older epoch may still see it.
+ * Readers never lock or wait for writers, writers only lock each other out of the list of retired versions.
+ *
+ * @see FrozenDCEL
+*/
+template<class T>
+class Published
+{
+    private:
+    atomic<T*> current;/**< The current version */
+    atomic<uint64_t> epoch;/**< The global epoch, starting from 1 */
+    atomic<uint64_t> slots[RCU_READERS];/**< The epoch every reader entered with, 0 for a free slot */
+    mutex retired_lock;/**< Guards retired */
+    vector<pair<T*,uint64_t>> retired;/**< The replaced versions and the epoch from which no new reader can see them */
+
+    public:
+    /**
+     * @brief A Class that keeps the version it read alive till it is destroyed
+     *
+     * The constructor takes the first free slot starting from one picked by the thread id.
+     * It only waits when all RCU_READERS slots are held, yielding after every full scan, and never waits for a writer.
+     * So a thread must not hold more than one Reader of the same pointer at a time,
+     * and with more than RCU_READERS threads reading at once the extra ones wait for a reader to finish.
+    */
+    class Reader
+    {
+        private:
+        Published& owner;/**< The pointer read */
+        int slot;/**< The slot taken in the pointer */
+        T* value;/**< The version read */
+
+        public:
+        Reader(Published& published) : owner(published)
+        {
+            size_t start = hash<thread::id>()(this_thread::get_id());
+            for(size_t i = 0; ; i++)
+            {
+                slot = (start + i)%RCU_READERS;
+                uint64_t e = owner.epoch.load();
+                uint64_t expected = 0;
+                if(owner.slots[slot].compare_exchange_strong(expected,e)) break;
+                if(i%RCU_READERS == RCU_READERS-1) this_thread::yield();
+            }
+            value = owner.current.load();
+        }
+
+        ~Reader()
+        {
+            owner.slots[slot].store(0);
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        /**
+         * @brief Returns the version read, NULL if nothing was published
+        */
+        const T* get() const
+        {
+            return value;
+        }
+
+        const T* operator->() const
+        {
+            return value;
+        }
+    };
+
+    Published(T* initial = NULL)
+    {
+        current.store(initial);
+        epoch.store(1);
+        for(int i = 0; i < RCU_READERS; i++) slots[i].store(0);
+    }
+
+    /**
+     * @brief Frees the current version and all the retired ones
+     *
+     * @note This function assumes that no reader is left
+    */
+    ~Published()
+    {
+        delete current.load();
+        for(auto& r : retired) delete r.first;
+    }
+
+    /**
+     * @brief Makes a new version visible to the readers that start from now
+     *
+     * @param next The new version, owned by the pointer from now
+     *
+     * The old version is retired and reclaim() is called to free the versions no reader can see any more.
+     *
+     * @see reclaim()
+     * @return void
+    */
+    void publish(T* next)
+    {
+        T* old = current.exchange(next);
+        uint64_t e = epoch.fetch_add(1) + 1;
+        if(old != NULL)
+        {
+            lock_guard<mutex> guard(retired_lock);
+            retired.push_back({old,e});
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Frees the retired versions that no reader can see any more
+     *
+     * @return The no of versions freed
+    */
+    int reclaim()
+    {
+        uint64_t oldest = UINT64_MAX;
+        for(int i = 0; i < RCU_READERS; i++)
+        {
+            uint64_t e = slots[i].load();
+            if(e != 0) oldest = min(oldest,e);
+        }
+        vector<T*> done;
+        {
+            lock_guard<mutex> guard(retired_lock);
+            vector<pair<T*,uint64_t>> waiting;
+            for(auto& r : retired)
+            {
+                if(r.second <= oldest) done.push_back(r.first);
+                else waiting.push_back(r);
+            }
+            retired.swap(waiting);
+        }
+        for(T* t : done) delete t;
+        return done.size();
+    }
+
+    /**
+     * @brief Returns the no of retired versions that are not freed yet
+    */
+    int pending()
+    {
+        lock_guard<mutex> guard(retired_lock);
+        return retired.size();
+    }
+};
+
+/**
+ * @brief A struct representing the result of stress_published()
+*/
+struct StressReport
+{
+    bool valid;/**< True if every check passed */
+    long long reads;/**< The no of versions walked by the readers */
+    int versions;/**< The no of versions published */
+    int torn;/**< The no of walks that did not see the frozen DCEL as it was */
+    int leaked;/**< The no of retired versions not freed once the readers were done */
+};
+
+/**
+ * @brief Publishes a DCEL over and over while reader threads walk every face of the version they see
+ *
+ * @param dcel The finished DCEL, it is frozen once for every version
+ * @param versions The no of versions to publish
+ * @param readers The no of reader threads, 0 to use one per core
+ *
+ * Every version holds the same DCEL, so every walk must find the same no of faces and vertices on them as the first one.
+ * A walk that finds other counts read a version that was freed or changed under it.
+ * Once the readers are done reclaim() must free every retired version.
+ *
+ * @see Published , FrozenDCEL
+ * @return The report of the checks
+*/
+StressReport stress_published(DCEL& dcel,int versions,int readers = 0)
+{
+    if(readers <= 0) readers = max(1u,thread::hardware_concurrency());
+    readers = min(readers,RCU_READERS);
+    FrozenDCEL* first = new FrozenDCEL(dcel);
+    auto walk = [](const FrozenDCEL* frozen)
+    {
+        long long total = 0;
+        for(int f = 0; f < frozen->face_count(); f++) total += frozen->face(f).size();
+        return total;
+    };
+    long long expected = walk(first);
+    int faces = first->face_count();
+
+    Published<FrozenDCEL> published(first);
+    atomic<bool> done(false);
+    atomic<long long> reads(0);
+    atomic<int> torn(0);
+    auto read = [&]()
+    {
+        do {
+            Published<FrozenDCEL>::Reader reader(published);
+            if(reader->face_count() != faces || walk(reader.get()) != expected) torn++;
+            reads++;
+        }while(!done.load());
+    };
+    vector<thread> workers;
+    for(int t = 0; t < readers; t++) workers.push_back(thread(read));
+    for(int v = 1; v < versions; v++) published.publish(new FrozenDCEL(dcel));
+    done.store(true);
+    for(auto& worker : workers) worker.join();
+    published.reclaim();
+
+    StressReport report;
+    report.reads = reads.load();
+    report.versions = max(1,versions);
+    report.torn = torn.load();
+    report.leaked = published.pending();
+    report.valid = report.torn == 0 && report.leaked == 0;
+    return report;
+}
+
+/**
+ * @brief Writes a stress report as a single line
+ *
+ * @param out The stream to write into
+ * @param report The report
+ * @return void
+*/
+void print_report(ostream& out,StressReport& report)
+{
+    out<<(report.valid ? "valid" : "invalid")<<" versions "<<report.versions<<" reads "<<report.reads
+        <<" torn "<<report.torn<<" leaked "<<report.leaked<<endl;
+}
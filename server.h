@@ -0,0 +1,125 @@
+/**
+ * @file server.h
+ * @brief This Header implements a long running server that decomposes polygons sent over stdin or a Unix domain socket
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "protocol.h"
+
+using namespace std;
+
+/**
+ * @brief A Class that reads polygon requests, decomposes them and writes back the pieces
+ *
+ * The buffers of the requests and replies are reused between requests.
+ * The decomposition is done by a handler called as handle(polygon,pieces) which returns the STATUS value of the reply.
+ *
+ * @see protocol.h
+*/
+class PolygonServer
+{
+    private:
+    vector<char> request;/**< The payload of the current request */
+    vector<char> reply;/**< The payload of the current reply */
+    vector<pair<double,double>> polygon;/**< The polygon of the current request */
+    vector<vector<int>> pieces;/**< The pieces of the current request */
+    bool stopped;/**< True once a stop request has been received */
+    public:
+    LatencyTracker latency;/**< The latency of the requests handled so far */
+
+    public:
+    PolygonServer()
+    {
+        stopped = false;
+    }
+
+    /**
+     * @brief Handles requests from a stream till it ends or a stop request is received
+     *
+     * @param in The file descriptor requests are read from
+     * @param out The file descriptor replies are written to
+     * @param handle The decomposition handler
+     *
+     * The latency of a request is measured from the time it is read till its reply is written.
+     *
+     * @see read_frame() , write_frame() , LatencyTracker
+     * @return void
+    */
+    template<class Handler>
+    void serve(int in,int out,Handler& handle)
+    {
+        while(!stopped && read_frame(in,request))
+        {
+            if(request.empty())
+            {
+                stopped = true;
+                break;
+            }
+            auto start = chrono::steady_clock::now();
+            pieces.clear();
+            uint32_t status = decode_polygon(request,polygon) ? handle(polygon,pieces) : STATUS_INVALID;
+            if(status == STATUS_INVALID) pieces.clear();
+            encode_pieces(status,pieces,reply);
+            if(!write_frame(out,reply)) break;
+            latency.add(chrono::duration<double,milli>(chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    /**
+     * @brief Listens on a Unix domain socket and handles one connection at a time till a stop request is received
+     *
+     * @param path The path of the socket, an existing file at the path is removed
+     * @param handle The decomposition handler
+     *
+     * The latency percentiles are written to stderr after every connection.
+     *
+     * @see serve()
+     * @return false if the socket could not be created
+    */
+    template<class Handler>
+    bool listen_socket(string path,Handler& handle)
+    {
+        signal(SIGPIPE,SIG_IGN);
+        int fd = socket(AF_UNIX,SOCK_STREAM,0);
+        if(fd == -1) return false;
+        sockaddr_un addr;
+        memset(&addr,0,sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(addr.sun_path))
+        {
+            close(fd);
+            return false;
+        }
+        strcpy(addr.sun_path,path.c_str());
+        unlink(path.c_str());
+        if(bind(fd,(sockaddr*)&addr,sizeof(addr)) == -1 || listen(fd,16) == -1)
+        {
+            close(fd);
+            return false;
+        }
+        while(!stopped)
+        {
+            int client = accept(fd,NULL,NULL);
+            if(client == -1)
+            {
+                if(errno == EINTR) continue;
+                break;
+            }
+            serve(client,client,handle);
+            close(client);
+            latency.report(cerr,"server");
+        }
+        close(fd);
+        unlink(path.c_str());
+        return true;
+    }
+};
@@ -0,0 +1,401 @@
+/**
+ * @file small.h
+ * @brief This Header implements the decomposition of convex and small polygons without building a DCEL
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include "helper_functions.h"
+#include "budget.h"
+
+using namespace std;
+
+#define SMALL_POLYGON 16/**< The largest polygon decomposed by SmallDecomposer */
+
+/**
+ * @brief A Class that splits and merges a polygon of atmost MaxN vertices using fixed size arrays
+ *
+ * It follows the same steps as split(), DCEL::addDiagonal() and DCEL::merge() but the half edges, faces and the LP map are
+ * arrays indexed by vertex and half edge numbers so nothing is allocated.
+ * Half edge i for i < n goes from vertex i to i+1 and its twin is n+i, the diagonals come after them in pairs.
+ * The split and the merge spend from the same Budget as split_pieces() and DCEL::merge() and fall back the same way.
+ *
+ * @see split() , DCEL , Budget
+*/
+template<int MaxN>
+class SmallDecomposer
+{
+    private:
+    static const int MaxH = 4*MaxN;/**< The largest no of half edges, the edges and atmost n-3 diagonals */
+    Vertex v[MaxN];/**< The vertices in clockwise order */
+    int n;/**< The no of vertices */
+    bool notch[MaxN];/**< True if the vertex is a notch */
+    int org[MaxH];/**< The origin vertex of every half edge */
+    int twin[MaxH];/**< The twin of every half edge */
+    int next[MaxH];/**< The next half edge in the face */
+    int prev[MaxH];/**< The previous half edge in the face */
+    int h;/**< The no of half edges */
+    int face[MaxN];/**< The incident half edge of every face */
+    int faces;/**< The no of faces */
+    int diagonal[MaxN];/**< The half edge of every diagonal */
+    int diagonals;/**< The no of diagonals */
+    bitset<MaxN> LP[MaxN];/**< The vertices joined to every vertex by a diagonal */
+
+    /**
+     * @brief Same as insidePolygon() for a polygon given as vertex numbers
+    */
+    bool inside(int* polygon,int size,Vertex* p)
+    {
+        if(size <= 2) return false;
+        int count = 0;
+        for(int i = 0; i < size; i++)
+        {
+            Vertex* v1 = &v[polygon[i]];
+            Vertex* v2 = &v[polygon[(i+1)%size]];
+            if((v1->y > p->y) != (v2->y > p->y))
+            {
+                double x = (v2->x-v1->x)*(p->y-v1->y)/(v2->y-v1->y) + v1->x;
+                if(p->x < x) count++;
+            }
+        }
+        return count % 2 == 1;
+    }
+
+    /**
+     * @brief Same as DCEL::addDiagonal() for the diagonal between vertices a and b, an edge of the polygon is skipped like DCEL::addDiagonals() does
+    */
+    void addDiagonal(int a,int b)
+    {
+        if(a == b || (a+1)%n == b || (b+1)%n == a) return;
+        int aStart = -1;
+        int bStart = -1;
+        int req = -1;
+        for(int f = 0; f < faces && req == -1; f++)
+        {
+            int cnt = 0;
+            int curr = face[f];
+            do {
+                if(org[curr] == a) { aStart = curr; cnt++; }
+                if(org[curr] == b) { bStart = curr; cnt++; }
+                curr = next[curr];
+            }while(curr != face[f]);
+            if(cnt == 2) req = f;
+        }
+        if(req == -1 || LP[a][b] || LP[b][a]) return;
+        int e = h++;
+        int t = h++;
+        org[e] = b;
+        org[t] = a;
+        twin[e] = t;
+        twin[t] = e;
+        next[e] = aStart;
+        prev[e] = prev[bStart];
+        next[t] = bStart;
+        prev[t] = prev[aStart];
+        next[prev[bStart]] = e;
+        next[prev[aStart]] = t;
+        prev[bStart] = t;
+        prev[aStart] = e;
+        diagonal[diagonals] = e;
+        diagonals++;
+        LP[a][b] = true;
+        LP[b][a] = true;
+        face[req] = e;
+        face[faces++] = t;
+    }
+
+    /**
+     * @brief Same as DCEL::removeDiagonal() for the diagonal with half edge d
+    */
+    void removeDiagonal(int d)
+    {
+        int t = twin[d];
+        int kept = -1;
+        for(int f = 0; f < faces; f++)
+        {
+            int curr = face[f];
+            bool found = false;
+            do {
+                if(curr == d || curr == t) found = true;
+                curr = next[curr];
+            }while(curr != face[f]);
+            if(!found) continue;
+            if(kept == -1)
+            {
+                kept = f;
+                continue;
+            }
+            face[f] = face[--faces];
+            break;
+        }
+        next[prev[d]] = next[t];
+        prev[next[t]] = prev[d];
+        prev[next[d]] = prev[t];
+        next[prev[t]] = next[d];
+        face[kept] = next[d];
+    }
+
+    /**
+     * @brief Same as split() on the vertices 0 to n-1
+     *
+     * @param budget The budget that bounds the split, NULL for no limit
+     *
+     * A step that cuts nothing off starts the next step one vertex further, so once as many such steps as there are
+     * vertices left follow each other the loop would repeat forever, which only happens if the polygon is not simple.
+     *
+     * @return false if the split made no progress
+    */
+    bool split(Budget* budget)
+    {
+        int vertices[MaxN];
+        int m = n;
+        for(int i = 0; i < n; i++) vertices[i] = i;
+        int first[MaxN];
+        int last[MaxN];
+        int pieces = 0;
+        int polygon[MaxN];
+        int stalled = 0;
+        while(m > 3)
+        {
+            if(budget != NULL && !budget->spend(m))
+            {
+                //Same as the fallback of split_pieces()
+                vector<Vertex*> rest;
+                for(int j = 0; j < m; j++) rest.push_back(&v[vertices[j]]);
+                for(auto& triangle : triangulate(rest))
+                {
+                    first[pieces] = triangle[0] - v;
+                    last[pieces] = triangle[2] - v;
+                    pieces++;
+                }
+                budget->path = PATH_TRIANGULATED;
+                break;
+            }
+            int size = 0;
+            polygon[size++] = vertices[0];
+            polygon[size++] = vertices[1];
+            int i = size-1;
+            int new_v = vertices[i+1];
+            while(ang(&v[polygon[i-1]],&v[polygon[i]],&v[new_v]) >= 0 && ang(&v[polygon[i]],&v[new_v],&v[polygon[0]]) >= 0 && ang(&v[new_v],&v[polygon[0]],&v[polygon[1]]) >= 0)
+            {
+                polygon[size++] = new_v;
+                i = size-1;
+                if(i+1 >= m) break;
+                new_v = vertices[i+1];
+            }
+            if(size != m)
+            {
+                int notches[MaxN];
+                int count = 0;
+                for(int j = size; j < m; j++)
+                {
+                    if(isNotch(&v[vertices[j-1]],&v[vertices[j]],&v[vertices[(j+1)%m]])) notches[count++] = vertices[j];
+                }
+                bool found;
+                do {
+                    found = false;
+                    double rect[4] = {v[polygon[0]].x,v[polygon[0]].x,v[polygon[0]].y,v[polygon[0]].y};
+                    for(int k = 1; k < size; k++)
+                    {
+                        rect[0] = min(rect[0],v[polygon[k]].x);
+                        rect[1] = max(rect[1],v[polygon[k]].x);
+                        rect[2] = min(rect[2],v[polygon[k]].y);
+                        rect[3] = max(rect[3],v[polygon[k]].y);
+                    }
+                    for(int k = 0; k < count && !found; k++)
+                    {
+                        Vertex* p = &v[notches[k]];
+                        if(rect[0] < p->x && rect[1] > p->x && rect[2] < p->y && rect[3] > p->y && inside(polygon,size,p))
+                        {
+                            //Same as removeFromSemiPlane()
+                            found = true;
+                            int end = polygon[--size];
+                            while(size > 2 && sameSide(&v[polygon[0]],p,&v[end],&v[polygon[size-1]])) size--;
+                        }
+                    }
+                }while(found);
+                if(size != 2)
+                {
+                    first[pieces] = polygon[0];
+                    last[pieces] = polygon[size-1];
+                    pieces++;
+                    stalled = 0;
+                }
+                else if(++stalled >= m)
+                {
+                    return false;
+                }
+                int k = 0;
+                for(int j = size-1; j < m; j++) vertices[k++] = vertices[j];
+                vertices[k++] = polygon[0];
+                m = k;
+            }
+            else
+            {
+                first[pieces] = polygon[0];
+                last[pieces] = polygon[size-1];
+                pieces++;
+                break;
+            }
+        }
+        for(int k = 0; k < pieces; k++) addDiagonal(first[k],last[k]);
+        return true;
+    }
+
+    /**
+     * @brief Same as DCEL::merge()
+     *
+     * @param budget The budget that bounds the merge, NULL for no limit
+    */
+    void merge(Budget* budget)
+    {
+        for(int i = 0; i < diagonals; i++)
+        {
+            if(budget != NULL && !budget->spend())
+            {
+                if(budget->path == PATH_FULL) budget->path = PATH_SPLIT_ONLY;
+                break;
+            }
+            int d = diagonal[i];
+            int vs = org[d];
+            int vt = org[twin[d]];
+            int size_s = LP[vs].count();
+            int size_t = LP[vt].count();
+            if(!((size_s>2 && size_t>2) || (size_s>2 && !notch[vt]) || (size_t>2 && !notch[vs]) || (!notch[vs] && !notch[vt]))) continue;
+            int j3 = org[twin[next[d]]];
+            int i3 = org[twin[next[twin[d]]]];
+            int i1 = org[prev[d]];
+            int j1 = org[prev[twin[d]]];
+            if(ang(&v[i1],&v[vs],&v[i3]) >= 0 && ang(&v[j1],&v[vt],&v[j3]) >= 0)
+            {
+                LP[vs][vt] = false;
+                LP[vt][vs] = false;
+                removeDiagonal(d);
+            }
+        }
+    }
+
+    public:
+    /**
+     * @brief Decomposes a polygon into convex pieces
+     *
+     * @param polygon The vertices of the polygon in clockwise order, atmost MaxN of them
+     * @param index The number reported for every vertex in the pieces
+     * @param pieces The vector into which the numbers of the vertices of every piece are written
+     * @param budget The budget that bounds the split and the merge, NULL for no limit
+     *
+     * @return false if the polygon is not simple and the split made no progress, nothing is written then
+    */
+    bool decompose(Vertex* polygon,int* index,int size,vector<vector<int>>& pieces,Budget* budget = NULL)
+    {
+        n = size;
+        #pragma GCC unroll 16
+        for(int i = 0; i < MaxN; i++)
+        {
+            if(i >= n) break;
+            v[i] = polygon[i];
+            LP[i].reset();
+        }
+        bool convex = true;
+        #pragma GCC unroll 16
+        for(int i = 0; i < MaxN; i++)
+        {
+            if(i >= n) break;
+            notch[i] = isNotch(&v[(i+n-1)%n],&v[i],&v[(i+1)%n]);
+            convex = convex && !notch[i];
+        }
+        if(convex)
+        {
+            pieces.push_back(vector<int>(index,index+n));
+            return true;
+        }
+        for(int i = 0; i < n; i++)
+        {
+            org[i] = i;
+            org[n+i] = (i+1)%n;
+            twin[i] = n+i;
+            twin[n+i] = i;
+            next[i] = (i+1)%n;
+            prev[i] = (i+n-1)%n;
+            next[n+i] = n+(i+n-1)%n;
+            prev[n+i] = n+(i+1)%n;
+        }
+        h = 2*n;
+        face[0] = 0;
+        faces = 1;
+        diagonals = 0;
+        if(!split(budget)) return false;
+        merge(budget);
+        for(int f = 0; f < faces; f++)
+        {
+            vector<int> piece;
+            int curr = face[f];
+            do {
+                piece.push_back(index[org[curr]]);
+                curr = next[curr];
+            }while(curr != face[f]);
+            pieces.push_back(piece);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Decomposes a polygon without building a DCEL if it is convex or has atmost SMALL_POLYGON vertices
+ *
+ * @param mpl The X and Y coordinates of the vertices in any orientation
+ * @param pieces The vector into which the indices in mpl of the vertices of every convex piece are written
+ * @param budget The budget that bounds the SmallDecomposer, NULL for no limit
+ * @param valid The variable set to false if a small polygon turned out not to be simple, can be NULL
+ *
+ * A convex polygon is returned as a single piece after one pass over the vertices.
+ * Small polygons go to the SmallDecomposer with the smallest size that fits.
+ *
+ * @see SmallDecomposer , IsClockwise() , isNotch() , Budget
+ * @return false if the polygon is neither convex nor small, nothing is written then
+*/
+bool decompose_small(vector<pair<double,double>>& mpl,vector<vector<int>>& pieces,Budget* budget = NULL,bool* valid = NULL)
+{
+    int n = mpl.size();
+    bool dir = IsClockwise(mpl);
+    auto at = [&](int i) { int k = dir ? i : n-1-i; return Vertex{mpl[k].first,mpl[k].second}; };
+    if(n > SMALL_POLYGON)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            Vertex v1 = at((i+n-1)%n);
+            Vertex v2 = at(i);
+            Vertex v3 = at((i+1)%n);
+            if(isNotch(&v1,&v2,&v3)) return false;
+        }
+        vector<int> piece;
+        for(int i = 0; i < n; i++) piece.push_back(dir ? i : n-1-i);
+        pieces.push_back(piece);
+        return true;
+    }
+    Vertex polygon[SMALL_POLYGON];
+    int index[SMALL_POLYGON];
+    for(int i = 0; i < n; i++)
+    {
+        polygon[i] = at(i);
+        index[i] = dir ? i : n-1-i;
+    }
+    bool simple;
+    if(n <= 8)
+    {
+        SmallDecomposer<8> kernel;
+        simple = kernel.decompose(polygon,index,n,pieces,budget);
+    }
+    else
+    {
+        SmallDecomposer<SMALL_POLYGON> kernel;
+        simple = kernel.decompose(polygon,index,n,pieces,budget);
+    }
+    if(valid != NULL) *valid = simple;
+    return true;
+}
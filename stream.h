@@ -0,0 +1,746 @@
+/**
+ * @file stream.h
+ * @brief This Header implements the Split Algorithm over a memory mapped file with bounded memory
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "helper_functions.h"
+
+using namespace std;
+
+/**
+ * @brief A vertex of the streamed polygon along with its index in the input file
+*/
+struct StreamVertex
+{
+    long index;/**< The index of the vertex in the input file */
+    Vertex v;/**< The coordinates of the vertex */
+};
+
+/**
+ * @brief A Class that reads the vertices of a polygon from a memory mapped binary file
+ *
+ * The file starts with the no of vertices as a 64 bit integer followed by the X and Y coordinates of every vertex as doubles.
+ * The vertices are returned in clockwise order, if the file is anticlockwise it is read from the end.
+ * Pages that are already consumed are given back to the kernel so only the recently used pages are resident.
+*/
+class VertexStream
+{
+    private:
+    int fd;/**< The file descriptor of the input file */
+    char* data;/**< The start of the mapping */
+    size_t size;/**< The size of the mapping in bytes */
+    long released;/**< The no of vertices whose pages have been released */
+    size_t chunk;/**< The no of bytes released at once */
+    public:
+    long n;/**< The no of vertices in the file */
+    bool reverse;/**< True if the vertices are read from the end of the file */
+    vector<double> rect;/**< The bounding rectangle of the polygon as in getRectangle() */
+
+    public:
+    VertexStream()
+    {
+        fd = -1;
+        data = NULL;
+        size = 0;
+        released = 0;
+        chunk = 1<<20;
+        n = 0;
+        reverse = false;
+    }
+
+    ~VertexStream()
+    {
+        if(data != NULL) munmap(data,size);
+        if(fd != -1) close(fd);
+    }
+
+    /**
+     * @brief Maps the file and finds the orientation of the polygon
+     *
+     * @param file_name The name of the binary file
+     * @param chunk_size The no of bytes read before the pages behind are released
+     *
+     * The orientation is found with a single pass over the file, releasing the pages as it goes
+     *
+     * @see IsClockwise()
+     * @return true if the file could be mapped
+    */
+    bool open_file(string file_name,size_t chunk_size)
+    {
+        chunk = max(chunk_size,(size_t)sysconf(_SC_PAGESIZE));
+        fd = open(file_name.c_str(),O_RDONLY);
+        if(fd == -1) return false;
+        struct stat st;
+        if(fstat(fd,&st) == -1 || st.st_size < (off_t)sizeof(int64_t)) return false;
+        size = st.st_size;
+        void* p = mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(p == MAP_FAILED)
+        {
+            data = NULL;
+            return false;
+        }
+        data = (char*)p;
+        madvise(data,size,MADV_SEQUENTIAL);
+        int64_t count;
+        memcpy(&count,data,sizeof(count));
+        if(count < 3 || sizeof(int64_t) + (size_t)count*2*sizeof(double) > size) return false;
+        n = count;
+
+        //Same sum as IsClockwise() computed without holding the vertices
+        double sum = 0.0;
+        rect = {INFINITY,-INFINITY,INFINITY,-INFINITY};
+        for(long i = 0; i < n; i++)
+        {
+            Vertex a = get(i);
+            Vertex b = get((i+1)%n);
+            sum += (b.x - a.x) * (b.y + a.y);
+            rect[0] = min(rect[0],a.x);
+            rect[1] = max(rect[1],a.x);
+            rect[2] = min(rect[2],a.y);
+            rect[3] = max(rect[3],a.y);
+            release(i);
+        }
+        reverse = !(sum > 0.0);
+        rewind();
+        return true;
+    }
+
+    /**
+     * @brief Starts a new pass over the file from the first position
+     * @return void
+    */
+    void rewind()
+    {
+        released = 0;
+    }
+
+    /**
+     * @brief Returns the vertex at the given position in clockwise order
+     *
+     * @param i The position of the vertex
+     * @return The vertex
+    */
+    Vertex get(long i)
+    {
+        Vertex v;
+        memcpy(&v,data + sizeof(int64_t) + raw(i)*2*sizeof(double),sizeof(v));
+        return v;
+    }
+
+    /**
+     * @brief Returns the index in the file of the vertex at the given position in clockwise order
+     *
+     * @param i The position of the vertex
+     * @return The index of the vertex in the file
+    */
+    long raw(long i)
+    {
+        return reverse ? n-1-i : i;
+    }
+
+    /**
+     * @brief Releases the pages holding the vertices before the given position
+     *
+     * @param upto The first position that is still needed
+     *
+     * Only whole pages are released and only once a full chunk has been consumed
+     *
+     * @return void
+    */
+    void release(long upto)
+    {
+        if((upto - released)*2*sizeof(double) < chunk) return;
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin = sizeof(int64_t) + released*2*sizeof(double);
+        size_t end = sizeof(int64_t) + upto*2*sizeof(double);
+        if(reverse)
+        {
+            size_t total = sizeof(int64_t) + n*2*sizeof(double);
+            size_t b = total - end;
+            end = total - begin;
+            begin = b;
+        }
+        begin = (begin + page - 1) / page * page;
+        end = end / page * page;
+        if(begin < end) madvise(data + begin,end - begin,MADV_DONTNEED);
+        released = upto;
+    }
+};
+
+/**
+ * @brief A Class representing a queue of vertices kept in a temporary file
+ *
+ * Only the block being written and one block read back are held in memory.
+ * Vertices are numbered by a serial no that grows with every push and are read back by their position from the front.
+*/
+class SpillQueue
+{
+    private:
+    FILE* file;/**< The temporary file */
+    long head;/**< The serial no of the first vertex in the queue */
+    long total;/**< The no of vertices pushed so far */
+    vector<StreamVertex> buffer;/**< The vertices pushed but not written yet */
+    long buffer_start;/**< The serial no of the first vertex in the buffer */
+    vector<StreamVertex> cache;/**< A block of vertices read back from the file */
+    long cache_start;/**< The serial no of the first vertex in the cache */
+    long block;/**< The no of vertices written or read at once */
+
+    public:
+    SpillQueue(long block_size = 4096)
+    {
+        file = tmpfile();
+        head = 0;
+        total = 0;
+        buffer_start = 0;
+        cache_start = 0;
+        block = block_size;
+    }
+
+    ~SpillQueue()
+    {
+        if(file != NULL) fclose(file);
+    }
+
+    /**
+     * @brief The no of vertices in the queue
+    */
+    long size()
+    {
+        return total - head;
+    }
+
+    bool empty()
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Adds a vertex at the end of the queue
+     * @return void
+    */
+    void push_back(StreamVertex s)
+    {
+        buffer.push_back(s);
+        total++;
+        if((long)buffer.size() >= block)
+        {
+            pwrite(fileno(file),buffer.data(),buffer.size()*sizeof(StreamVertex),buffer_start*sizeof(StreamVertex));
+            buffer_start += buffer.size();
+            buffer.clear();
+        }
+    }
+
+    /**
+     * @brief Removes the vertex at the front of the queue
+     * @return void
+    */
+    void pop_front()
+    {
+        head++;
+    }
+
+    /**
+     * @brief Returns the vertex at the given position from the front of the queue
+    */
+    StreamVertex operator[](long k)
+    {
+        long serial = head + k;
+        if(serial >= buffer_start) return buffer[serial - buffer_start];
+        if(serial < cache_start || serial >= cache_start + (long)cache.size())
+        {
+            cache_start = serial/block*block;
+            cache.resize(min(block,buffer_start - cache_start));
+            pread(fileno(file),cache.data(),cache.size()*sizeof(StreamVertex),cache_start*sizeof(StreamVertex));
+        }
+        return cache[serial - cache_start];
+    }
+
+    StreamVertex back()
+    {
+        return (*this)[size()-1];
+    }
+};
+
+/**
+ * @brief A notch stored in a NotchGrid
+*/
+struct NotchRecord
+{
+    long position;/**< The position of the notch, its order along the polygon */
+    Vertex v;/**< The coordinates of the notch */
+};
+
+/**
+ * @brief A Class representing a uniform grid of notches kept in a temporary file
+ *
+ * Every cell is a chain of fixed size blocks in the file, only the first and last block of every cell and the
+ * no of records in the last block are kept in memory. A query reads the cells covering a rectangle and nothing else.
+ * Records are never removed, a query returns the ones that are no longer needed as well and the caller filters them by position.
+*/
+class NotchGrid
+{
+    private:
+    static const int BLOCK = 16;/**< The no of records in a block */
+    FILE* file;/**< The temporary file */
+    int side;/**< The no of cells along each axis */
+    vector<double> rect;/**< The rectangle covered by the grid */
+    vector<long> first;/**< The offset of the first block of every cell, -1 for an empty cell */
+    vector<long> last;/**< The offset of the last block of every cell */
+    vector<int> fill;/**< The no of records in the last block of every cell */
+    long blocks;/**< The no of blocks in the file */
+
+    /**
+     * @brief The size of a block in the file, the offset of the next block followed by the records
+    */
+    size_t block_size()
+    {
+        return sizeof(long) + BLOCK*sizeof(NotchRecord);
+    }
+
+    int column(double x)
+    {
+        return min(side-1,max(0,(int)((x - rect[0])/(rect[1] - rect[0])*side)));
+    }
+
+    int row(double y)
+    {
+        return min(side-1,max(0,(int)((y - rect[2])/(rect[3] - rect[2])*side)));
+    }
+
+    public:
+    NotchGrid()
+    {
+        file = NULL;
+        side = 0;
+        blocks = 0;
+    }
+
+    ~NotchGrid()
+    {
+        if(file != NULL) fclose(file);
+    }
+
+    /**
+     * @brief Creates an empty grid over the given rectangle
+     *
+     * @param bounds The rectangle as in getRectangle()
+     * @param n The no of vertices of the polygon, the grid has about n/16 cells and atmost 512 along each axis
+     * @return false if the temporary file could not be created
+    */
+    bool init(vector<double> bounds,long n)
+    {
+        file = tmpfile();
+        rect = bounds;
+        if(rect[1] <= rect[0]) rect[1] = rect[0] + 1;
+        if(rect[3] <= rect[2]) rect[3] = rect[2] + 1;
+        side = max(1,min(512,(int)sqrt(n/16.0)));
+        first.assign(side*side,-1);
+        last.assign(side*side,-1);
+        fill.assign(side*side,0);
+        blocks = 0;
+        return file != NULL;
+    }
+
+    /**
+     * @brief Adds a notch to the cell holding it
+     * @return void
+    */
+    void add(long position,Vertex v)
+    {
+        int fd = fileno(file);
+        int cell = row(v.y)*side + column(v.x);
+        if(first[cell] == -1 || fill[cell] == BLOCK)
+        {
+            long offset = blocks*block_size();
+            long none = -1;
+            pwrite(fd,&none,sizeof(long),offset);
+            blocks++;
+            if(first[cell] == -1) first[cell] = offset;
+            else pwrite(fd,&offset,sizeof(long),last[cell]);
+            last[cell] = offset;
+            fill[cell] = 0;
+        }
+        NotchRecord record = {position,v};
+        pwrite(fd,&record,sizeof(record),last[cell] + sizeof(long) + fill[cell]*sizeof(NotchRecord));
+        fill[cell]++;
+    }
+
+    /**
+     * @brief Checks if a cell lies strictly outside the line of one of the edges of a convex polygon
+     *
+     * @param cell The no of the cell
+     * @param polygon The convex polygon
+     * @return true if no point of the cell can be inside the polygon
+    */
+    bool outside(int cell,vector<Vertex*>& polygon)
+    {
+        double w = (rect[1] - rect[0])/side;
+        double h = (rect[3] - rect[2])/side;
+        //The cell is grown a little so a notch rounded into it by column() or row() is still covered
+        double x = rect[0] + (cell%side - 0.01)*w;
+        double y = rect[2] + (cell/side - 0.01)*h;
+        w *= 1.02;
+        h *= 1.02;
+        Vertex corners[4] = {{x,y},{x+w,y},{x,y+h},{x+w,y+h}};
+        int num = polygon.size();
+        double area = 0.0;
+        for(int i = 0; i < num; i++) area += cross(polygon[0],polygon[i],polygon[(i+1)%num]);
+        for(int i = 0; i < num; i++)
+        {
+            int k = 0;
+            while(k < 4 && cross(polygon[i],polygon[(i+1)%num],&corners[k])*area < 0) k++;
+            if(k == 4) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Finds the notches inside a rectangle
+     *
+     * @param bounds The rectangle as in getRectangle()
+     * @param polygon The convex polygon the rectangle was found from, the cells outside it are not read
+     * @param found The vector into which the notches strictly inside the rectangle are written
+     * @see insideRect()
+     * @return void
+    */
+    void query(vector<double>& bounds,vector<Vertex*>& polygon,vector<NotchRecord>& found)
+    {
+        int fd = fileno(file);
+        vector<char> data(block_size());
+        for(int r = row(bounds[2]); r <= row(bounds[3]); r++)
+        {
+            for(int c = column(bounds[0]); c <= column(bounds[1]); c++)
+            {
+                int cell = r*side + c;
+                if(first[cell] == -1 || outside(cell,polygon)) continue;
+                long offset = first[cell];
+                while(offset != -1)
+                {
+                    int count = offset == last[cell] ? fill[cell] : BLOCK;
+                    pread(fd,data.data(),sizeof(long) + count*sizeof(NotchRecord),offset);
+                    NotchRecord* records = (NotchRecord*)(data.data() + sizeof(long));
+                    for(int k = 0; k < count; k++)
+                    {
+                        if(insideRect(bounds,&records[k].v)) found.push_back(records[k]);
+                    }
+                    memcpy(&offset,data.data(),sizeof(long));
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief A Class that runs the Split Algorithm on a polygon that does not fit in memory
+ *
+ * The remaining polygon in the split algorithm is always the vertices of the file from a cursor till the end
+ * followed by the first vertices of the pieces cut so far, in the order they were cut.
+ * The vertices of the file are read from the mapping when needed and the rest is kept on disk
+ * - The notches of the polygon and of the vertices waiting at the end are kept in a NotchGrid
+ * - The vertices waiting at the end of the remaining polygon are kept in a SpillQueue
+ * Only the current piece, which is limited to the window size, the candidate notches of the piece and fixed size buffers are held in memory.
+ *
+ * Every piece is written to the output as soon as it is cut.
+ * With an unlimited window the pieces are the same as the ones found by split().
+*/
+class StreamSplitter
+{
+    private:
+    VertexStream in;/**< The input polygon */
+    NotchGrid grid;/**< The notches of the file at their position and of the tail at n plus their serial no */
+    SpillQueue tail;/**< The vertices waiting at the end of the remaining polygon */
+    long tail_base;/**< The serial no of the first vertex in the tail */
+    long cursor;/**< The position of the first vertex of the remaining polygon in the file */
+
+    public:
+    long pieces;/**< The no of pieces written */
+    bool simple;/**< False if the split stopped as it made no progress, which only happens if the polygon is not simple */
+
+    private:
+    /**
+     * @brief The no of vertices in the remaining polygon
+    */
+    long remaining()
+    {
+        return in.n - cursor + tail.size();
+    }
+
+    /**
+     * @brief Returns the vertex at the given position of the remaining polygon
+     *
+     * @param k The position of the vertex
+     * @return The vertex along with its index in the input file
+    */
+    StreamVertex at(long k)
+    {
+        long on_disk = in.n - cursor;
+        if(k < on_disk)
+        {
+            StreamVertex s;
+            s.index = in.raw(cursor + k);
+            s.v = in.get(cursor + k);
+            return s;
+        }
+        return tail[k - on_disk];
+    }
+
+    /**
+     * @brief Checks if the vertex at the given position of the remaining polygon is a notch
+     *
+     * @param k The position of the vertex
+     * @see isNotch()
+     * @return true if the vertex is a notch
+    */
+    bool notch_at(long k)
+    {
+        long size = remaining();
+        Vertex v1 = at((k-1+size)%size).v;
+        Vertex v2 = at(k).v;
+        Vertex v3 = at((k+1)%size).v;
+        return isNotch(&v1,&v2,&v3);
+    }
+
+    /**
+     * @brief Removes the given no of vertices from the front of the remaining polygon
+     *
+     * @param m The no of vertices to remove
+     * @return void
+    */
+    void pop_front(long m)
+    {
+        for(long i = 0; i < m; i++)
+        {
+            if(cursor < in.n)
+            {
+                cursor++;
+            }
+            else
+            {
+                tail.pop_front();
+                tail_base++;
+            }
+        }
+        in.release(cursor);
+    }
+
+    /**
+     * @brief Adds a vertex at the end of the remaining polygon
+     *
+     * The vertex before it now has both of its neighbours fixed so it is added to the grid if it is a notch.
+     * The first vertex of the tail is not added since its previous vertex changes as the file is consumed.
+     *
+     * @param s The vertex to add
+     * @return void
+    */
+    void push_back(StreamVertex s)
+    {
+        if(tail.size() >= 2)
+        {
+            StreamVertex last = tail.back();
+            Vertex v1 = tail[tail.size()-2].v;
+            if(isNotch(&v1,&last.v,&s.v)) grid.add(in.n + tail_base + tail.size() - 1,last.v);
+        }
+        tail.push_back(s);
+    }
+
+    /**
+     * @brief Collects the notches of the remaining polygon from the given position till the end that lie inside a rectangle
+     *
+     * @param from The first position to collect from
+     * @param polygon The piece, which is convex
+     * @param rect The rectangle as in getRectangle()
+     * @param notches The vector into which the notches are written in order of position
+     *
+     * The notches of the file and of the tail come from the grid, the ones already consumed or before the given position are skipped.
+     * The last vertex of the file and the first and last vertex of the tail have changing neighbours so they are checked directly.
+     *
+     * @see NotchGrid
+     * @return void
+    */
+    void collect_notches(long from,vector<Vertex*>& polygon,vector<double>& rect,vector<Vertex>& notches)
+    {
+        long size = remaining();
+        long on_disk = in.n - cursor;
+        vector<NotchRecord> found;
+        grid.query(rect,polygon,found);
+        //The position of every notch in the remaining polygon
+        vector<pair<long,Vertex>> keep;
+        for(NotchRecord& r : found)
+        {
+            long k;
+            if(r.position < in.n)
+            {
+                //Notches of the file with both neighbours in the file
+                if(r.position > in.n-2) continue;
+                k = r.position - cursor;
+            }
+            else
+            {
+                //Notches of the tail with both neighbours in the tail
+                long t = r.position - in.n - tail_base;
+                if(t <= 0 || t >= tail.size()-1) continue;
+                k = on_disk + t;
+            }
+            if(k >= from) keep.push_back({k,r.v});
+        }
+        if(on_disk >= 1 && on_disk-1 >= from && notch_at(on_disk-1)) keep.push_back({on_disk-1,at(on_disk-1).v});
+        if(!tail.empty())
+        {
+            if(on_disk >= from && notch_at(on_disk)) keep.push_back({on_disk,tail[0].v});
+            if(tail.size() >= 2 && size-1 >= from && notch_at(size-1)) keep.push_back({size-1,tail.back().v});
+        }
+        sort(keep.begin(),keep.end(),[](const pair<long,Vertex>& a,const pair<long,Vertex>& b){ return a.first < b.first; });
+        for(auto& p : keep)
+        {
+            if(insideRect(rect,&p.second)) notches.push_back(p.second);
+        }
+    }
+
+    /**
+     * @brief Writes a piece into the output
+     *
+     * @param fout The output stream
+     * @param piece The vertices of the piece
+     * @return void
+    */
+    void write_piece(ofstream& fout,deque<StreamVertex>& piece)
+    {
+        fout<<piece.size();
+        for(auto& s : piece) fout<<" "<<s.index;
+        fout<<"\n";
+        pieces++;
+    }
+
+    public:
+    StreamSplitter()
+    {
+        tail_base = 0;
+        cursor = 0;
+        pieces = 0;
+        simple = true;
+    }
+
+    /**
+     * @brief Runs the Split Algorithm on the polygon in the given file
+     *
+     * @param in_file The binary file having the polygon
+     * @param out_file The text file into which the pieces are written
+     * @param window The maximum no of vertices in a piece, 0 for no limit
+     * @param chunk_size The no of bytes of the input read before the pages behind are released
+     *
+     * The notches are found in one pass over the file and put in a grid, every piece then only reads the cells covering its rectangle.
+     * Then the same loop as split() is run on the remaining polygon, a piece stops growing once it reaches the window size.
+     * Every piece is written as the no of its vertices followed by their indices in the input file.
+     * The last remaining polygon is written as the last piece.
+     * Once as many steps that cut nothing off as there are vertices left follow each other the split stops and simple is set to false.
+     *
+     * @see split() , VertexStream , isNotch() , getRectangle() , insideRect() , insidePolygon() , removeFromSemiPlane()
+     * @return false if the input could not be read or the polygon is not simple
+    */
+    bool split(string in_file,string out_file,long window,size_t chunk_size)
+    {
+        if(!in.open_file(in_file,chunk_size)) return false;
+        ofstream fout(out_file);
+        long n = in.n;
+        if(!grid.init(in.rect,n)) return false;
+        for(long i = 0; i < n; i++)
+        {
+            Vertex v1 = in.get((i-1+n)%n);
+            Vertex v2 = in.get(i);
+            Vertex v3 = in.get((i+1)%n);
+            if(isNotch(&v1,&v2,&v3)) grid.add(i,v2);
+            in.release(i);
+        }
+        in.rewind();
+
+        //Pointers into a deque stay valid while it grows at the back
+        deque<StreamVertex> piece;
+        vector<Vertex*> polygon;
+        vector<Vertex> notches;
+        long stalled = 0;
+        while(remaining() > 3)
+        {
+            long size = remaining();
+            if(stalled >= size)
+            {
+                simple = false;
+                return false;
+            }
+            piece.clear();
+            polygon.clear();
+            piece.push_back(at(0));
+            piece.push_back(at(1));
+            polygon.push_back(&piece[0].v);
+            polygon.push_back(&piece[1].v);
+            int i = polygon.size()-1;
+            piece.push_back(at(i+1));
+            Vertex* new_v = &piece.back().v;
+            while(ang(polygon[i-1],polygon[i],new_v) >= 0 &&ang(polygon[i],new_v,polygon[0]) >= 0 && ang(new_v,polygon[0],polygon[1]) >= 0)
+            {
+                polygon.push_back(new_v);
+                i = polygon.size()-1;
+                if(i+1 >= size || (window > 0 && (long)polygon.size() >= window)) break;
+                piece.push_back(at(i+1));
+                new_v = &piece.back().v;
+            }
+            piece.resize(polygon.size());
+            if((long)polygon.size() != size)
+            {
+                notches.clear();
+                vector<double> bounds = getRectangle(polygon);
+                collect_notches(polygon.size(),polygon,bounds,notches);
+
+                Vertex* inside = NULL;
+                do {
+                    inside = NULL;
+                    vector<double> rect = getRectangle(polygon);
+                    for(int j=0;j<notches.size();j++)
+                    {
+                        if(insideRect(rect,&notches[j]) && insidePolygon(polygon,&notches[j]))
+                        {
+                            inside = &notches[j];
+                            break;
+                        }
+                    }
+                    if(inside != NULL)
+                    {
+                        removeFromSemiPlane(polygon,inside);
+                    }
+                }while(inside != NULL);
+                piece.resize(polygon.size());
+                if(polygon.size() != 2)
+                {
+                    write_piece(fout,piece);
+                    stalled = 0;
+                }
+                else
+                {
+                    stalled++;
+                }
+                StreamVertex first = piece[0];
+                pop_front(polygon.size()-1);
+                push_back(first);
+            }
+            else
+            {
+                write_piece(fout,piece);
+                return true;
+            }
+        }
+        piece.clear();
+        for(long k = 0; k < remaining(); k++) piece.push_back(at(k));
+        write_piece(fout,piece);
+        return true;
+    }
+};
@@ -0,0 +1,209 @@
+/**
+ * @file validate.h
+ * @brief This Header implements a parallel check of the convex decomposition held in a DCEL
+ * @author M Bhargav 2020A7PS0025H
+ * @author Tumu Akshar 2020A7PS0003H
+ * @author P V Rohith 2020A7PS0100H
+ * @author D V Sasanka 2020A7PS0005H
+ *
+ * @date 24-03-23
+*/
+#pragma once
+#include <bits/stdc++.h>
+#include "dcel.h"
+
+using namespace std;
+
+/**
+ * @brief A struct representing the result of validate()
+*/
+struct ValidationReport
+{
+    bool valid;/**< True if every check passed */
+    int faces;/**< The no of faces checked */
+    int diagonals;/**< The no of diagonals */
+    int broken_links;/**< The no of half edges whose twin or prev pointers do not match */
+    int non_convex;/**< The no of faces that are not convex */
+    int anticlockwise;/**< The no of faces that are not clockwise like the polygon */
+    int crossings;/**< The no of pairs of edges or diagonals that cross or overlap */
+    double area;/**< The total area of the faces */
+    double input_area;/**< The area of the input, NAN when it was not known */
+};
+
+/**
+ * @brief Checks that the faces of a DCEL are a convex decomposition of the polygon
+ *
+ * @param dcel A pointer to the DCEL
+ * @param input_area The area of the input before it was simplified or built into the DCEL, NAN to skip the area check
+ * @param area_error The largest difference allowed between the two areas beyond rounding, the simplification may move the boundary
+ * @param polygons The no of polygons in the DCEL, more than one for a map layer
+ * @param threads The no of threads, 0 to use one per core
+ *
+ * The faces are split between the threads and every face is walked once to check that
+ * - the twin of the twin and the prev of the next of every half edge is itself
+ * - every turn is clockwise or straight, so the face is convex
+ * - the face is clockwise
+ *
+ * The edges of the polygon and the diagonals are put in every cell of a uniform grid they pass through and the threads share out the cells.
+ * Every pair in a cell is tested with segmentsIntersect(), a pair found in more than one cell is counted once.
+ * Segments with one common end only fail if they overlap along a line, segments with both ends in common are the same edge.
+ *
+ * The areas of the faces are added up and must match the area of the input, which catches faces that were lost or counted twice.
+ * The no of faces must also be the no of polygons more than the no of diagonals.
+ *
+ * @see DCEL::getFaces() , DCEL::getEdges() , DCEL::getDiagonals() , polygonArea() , segmentsIntersect()
+ * @return The report of the checks
+*/
+ValidationReport validate(DCEL* dcel,double input_area,double area_error = 0,int polygons = 1,int threads = 0)
+{
+    vector<Face*> faces = dcel->getFaces();
+    if(threads <= 0) threads = max(1u,thread::hardware_concurrency());
+    threads = max(1,min<int>(threads,faces.size()/64 + 1));
+
+    vector<ValidationReport> partial(threads);
+
+    //The segments to test for crossings and the grid of the cells they pass through
+    vector<pair<Vertex*,Vertex*>> segments;
+    for(Edge* e : dcel->getEdges()) segments.push_back({e->org,e->twinEdge->org});
+    for(Edge* e : dcel->getDiagonals()) segments.push_back({e->org,e->twinEdge->org});
+    vector<double> rect = {INFINITY,-INFINITY,INFINITY,-INFINITY};
+    for(Vertex* v : dcel->vertices)
+    {
+        rect[0] = min(rect[0],v->x);
+        rect[1] = max(rect[1],v->x);
+        rect[2] = min(rect[2],v->y);
+        rect[3] = max(rect[3],v->y);
+    }
+    int side = max(1,(int)sqrt((double)segments.size()/4));
+    double width = max(rect[1]-rect[0],1e-300)/side;
+    double height = max(rect[3]-rect[2],1e-300)/side;
+    auto column = [&](double x) { return min(side-1,max(0,(int)((x-rect[0])/width))); };
+    auto row = [&](double y) { return min(side-1,max(0,(int)((y-rect[2])/height))); };
+    vector<vector<int>> grid(side*side);
+    for(size_t i = 0; i < segments.size(); i++)
+    {
+        Vertex* a = segments[i].first;
+        Vertex* b = segments[i].second;
+        if(a->x > b->x) swap(a,b);
+        //The part of the segment in every column gives the rows it passes through, grown a little against rounding
+        for(int c = column(a->x); c <= column(b->x); c++)
+        {
+            double x1 = max(a->x,rect[0] + c*width);
+            double x2 = min(b->x,rect[0] + (c+1)*width);
+            double y1 = a->y;
+            double y2 = b->y;
+            if(b->x > a->x)
+            {
+                y1 = a->y + (b->y - a->y)*(x1 - a->x)/(b->x - a->x);
+                y2 = a->y + (b->y - a->y)*(x2 - a->x)/(b->x - a->x);
+            }
+            for(int r = row(min(y1,y2) - height*1e-6); r <= row(max(y1,y2) + height*1e-6); r++) grid[r*side + c].push_back(i);
+        }
+    }
+    vector<vector<pair<int,int>>> crossed(threads);
+    auto crossing = [&](int i,int j)
+    {
+        Vertex* p1 = segments[i].first;
+        Vertex* p2 = segments[i].second;
+        Vertex* q1 = segments[j].first;
+        Vertex* q2 = segments[j].second;
+        if((p1 == q1 && p2 == q2) || (p1 == q2 && p2 == q1)) return false;
+        if(p2 == q1 || p2 == q2) swap(p1,p2);
+        if(q2 == p1) swap(q1,q2);
+        if(p1 == q1)
+        {
+            //Only a common end, they overlap if they leave it in the same direction
+            return cross(p1,p2,q2) == 0 && (p2->x-p1->x)*(q2->x-p1->x) + (p2->y-p1->y)*(q2->y-p1->y) > 0;
+        }
+        return segmentsIntersect(p1,p2,q1,q2);
+    };
+    auto check_crossings = [&](int t)
+    {
+        for(size_t cell = t; cell < grid.size(); cell += threads)
+        {
+            vector<int>& here = grid[cell];
+            for(size_t x = 0; x < here.size(); x++)
+            {
+                for(size_t y = x+1; y < here.size(); y++)
+                {
+                    if(crossing(here[x],here[y])) crossed[t].push_back({min(here[x],here[y]),max(here[x],here[y])});
+                }
+            }
+        }
+    };
+    //No face can be longer than all the half edges together, this stops the walk on a broken cycle
+    size_t limit = 2*(dcel->vertices.size() + dcel->getDiagonals().size()) + 1;
+    auto check = [&](int t)
+    {
+        ValidationReport& r = partial[t];
+        r.faces = r.broken_links = r.non_convex = r.anticlockwise = 0;
+        r.area = 0;
+        for(size_t f = t; f < faces.size(); f += threads)
+        {
+            Edge* start = faces[f]->incidentEdge;
+            Edge* curr = start;
+            double twice_area = 0;
+            bool convex = true;
+            size_t steps = 0;
+            do {
+                if(curr->twinEdge == NULL || curr->twinEdge->twinEdge != curr || curr->next == NULL || curr->next->prev != curr)
+                {
+                    r.broken_links++;
+                    break;
+                }
+                Vertex* v1 = curr->org;
+                Vertex* v2 = curr->next->org;
+                Vertex* v3 = curr->next->next->org;
+                twice_area += (v2->x - v1->x)*(v2->y + v1->y);
+                double turn = cross(v1,v2,v3);
+                double scale = hypot(v2->x - v1->x,v2->y - v1->y)*hypot(v3->x - v2->x,v3->y - v2->y);
+                if(turn > 1e-9*scale) convex = false;
+                curr = curr->next;
+            }while(curr != start && ++steps < limit);
+            if(steps >= limit) r.broken_links++;
+            if(!convex) r.non_convex++;
+            if(twice_area <= 0) r.anticlockwise++;
+            r.area += twice_area/2;
+            r.faces++;
+        }
+        check_crossings(t);
+    };
+    vector<thread> workers;
+    for(int t = 1; t < threads; t++) workers.push_back(thread(check,t));
+    check(0);
+    for(auto& worker : workers) worker.join();
+
+    ValidationReport report = partial[0];
+    for(int t = 1; t < threads; t++)
+    {
+        report.faces += partial[t].faces;
+        report.broken_links += partial[t].broken_links;
+        report.non_convex += partial[t].non_convex;
+        report.anticlockwise += partial[t].anticlockwise;
+        report.area += partial[t].area;
+    }
+    vector<pair<int,int>> pairs;
+    for(auto& c : crossed) pairs.insert(pairs.end(),c.begin(),c.end());
+    sort(pairs.begin(),pairs.end());
+    report.crossings = unique(pairs.begin(),pairs.end()) - pairs.begin();
+    report.diagonals = dcel->getDiagonals().size();
+    report.input_area = input_area;
+    bool same_area = isnan(input_area) || fabs(report.area - input_area) <= area_error + 1e-9*max(1.0,fabs(input_area));
+    report.valid = report.broken_links == 0 && report.non_convex == 0 && report.anticlockwise == 0 && report.crossings == 0
+        && same_area && report.faces == report.diagonals + polygons;
+    return report;
+}
+
+/**
+ * @brief Writes a validation report as a single line
+ *
+ * @param out The stream to write into
+ * @param report The report
+ * @return void
+*/
+void print_report(ostream& out,ValidationReport& report)
+{
+    out<<(report.valid ? "valid" : "invalid")<<" faces "<<report.faces<<" diagonals "<<report.diagonals
+        <<" broken_links "<<report.broken_links<<" non_convex "<<report.non_convex<<" anticlockwise "<<report.anticlockwise
+        <<" crossings "<<report.crossings<<" area "<<setprecision(12)<<report.area<<" input_area "<<report.input_area<<endl;
+}